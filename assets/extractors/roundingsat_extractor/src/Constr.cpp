@@ -72,6 +72,10 @@ void Clause::initializeWatches(CRef cr, Solver& solver) {
       }
     }
   }
+  if (length == 2) {  // binary clauses propagate from the watch alone
+    for (unsigned int i = 0; i < 2; ++i) adj[data[i]].push_back(Watch::binary(cr, data[1 - i]));
+    return;
+  }
   for (unsigned int i = 0; i < 2; ++i) adj[data[i]].emplace_back(cr, data[1 - i] - INF);  // add blocked literal
 }
 
@@ -81,7 +85,7 @@ WatchStatus Clause::checkForPropagation(CRef cr, int& idx, Lit p, Solver& solver
 
   assert(idx < 0);
   assert(p == data[0] || p == data[1]);
-  assert(size() > 1);
+  assert(size() > 2);
   int widx = 0;
   Lit watch = data[0];
   Lit otherwatch = data[1];
@@ -142,7 +146,7 @@ CeSuper Clause::toExpanded(ConstrExpPools& cePools) const {
   return result;
 }
 
-bool Clause::isSatisfiedAtRoot(const IntVecIt& level) const {
+bool Clause::isSatisfiedAtRoot(const Levels& level) const {
   for (int i = 0; i < (int)size(); ++i) {
     if (isUnit(level, data[i])) return true;
   }
@@ -257,7 +261,7 @@ CeSuper Cardinality::toExpanded(ConstrExpPools& cePools) const {
   return result;
 }
 
-bool Cardinality::isSatisfiedAtRoot(const IntVecIt& level) const {
+bool Cardinality::isSatisfiedAtRoot(const Levels& level) const {
   int eval = -degr;
   for (int i = 0; i < (int)size() && eval < 0; ++i)
     if (isUnit(level, data[i])) ++eval;
@@ -359,7 +363,7 @@ CeSuper Counting<CF, DG>::toExpanded(ConstrExpPools& cePools) const {
 }
 
 template <typename CF, typename DG>
-bool Counting<CF, DG>::isSatisfiedAtRoot(const IntVecIt& level) const {
+bool Counting<CF, DG>::isSatisfiedAtRoot(const Levels& level) const {
   DG eval = -degr;
   for (int i = 0; i < (int)size() && eval < 0; ++i)
     if (isUnit(level, data[i].l)) eval += data[i].c;
@@ -509,7 +513,7 @@ CeSuper Watched<CF, DG>::toExpanded(ConstrExpPools& cePools) const {
 }
 
 template <typename CF, typename DG>
-bool Watched<CF, DG>::isSatisfiedAtRoot(const IntVecIt& level) const {
+bool Watched<CF, DG>::isSatisfiedAtRoot(const Levels& level) const {
   DG eval = -degr;
   for (int i = 0; i < (int)size() && eval < 0; ++i)
     if (isUnit(level, data[i].l)) eval += aux::abs(data[i].c);
@@ -615,7 +619,7 @@ CeSuper CountingSafe<CF, DG>::toExpanded(ConstrExpPools& cePools) const {
 }
 
 template <typename CF, typename DG>
-bool CountingSafe<CF, DG>::isSatisfiedAtRoot(const IntVecIt& level) const {
+bool CountingSafe<CF, DG>::isSatisfiedAtRoot(const Levels& level) const {
   DG eval = -*degr;
   for (int i = 0; i < (int)size() && eval < 0; ++i)
     if (isUnit(level, terms[i].l)) eval += terms[i].c;
@@ -767,7 +771,7 @@ CeSuper WatchedSafe<CF, DG>::toExpanded(ConstrExpPools& cePools) const {
 }
 
 template <typename CF, typename DG>
-bool WatchedSafe<CF, DG>::isSatisfiedAtRoot(const IntVecIt& level) const {
+bool WatchedSafe<CF, DG>::isSatisfiedAtRoot(const Levels& level) const {
   DG eval = -*degr;
   for (int i = 0; i < (int)size() && eval < 0; ++i)
     if (isUnit(level, terms[i].l)) eval += aux::abs(terms[i].c);
@@ -893,4 +897,57 @@ template struct WatchedSafe<long long, int128>;
 template struct WatchedSafe<int128, int128>;
 template struct WatchedSafe<bigint, bigint>;
 
+// The type tag replaces the virtual calls on the hottest path of the solver, and with all implementations in this
+// translation unit, the calls below are direct and can be inlined.
+WatchStatus Constr::checkForPropagation(CRef cr, int& idx, Lit p, Solver& solver) {
+  switch (getType()) {
+    case ConstrType::CLAUSE:
+      return static_cast<Clause*>(this)->checkForPropagation(cr, idx, p, solver);
+    case ConstrType::CARDINALITY:
+      return static_cast<Cardinality*>(this)->checkForPropagation(cr, idx, p, solver);
+    case ConstrType::COUNTING32:
+      return static_cast<Counting32*>(this)->checkForPropagation(cr, idx, p, solver);
+    case ConstrType::WATCHED32:
+      return static_cast<Watched32*>(this)->checkForPropagation(cr, idx, p, solver);
+    case ConstrType::COUNTINGSAFE64:
+      return static_cast<CountingSafe64*>(this)->checkForPropagation(cr, idx, p, solver);
+    case ConstrType::COUNTINGSAFE96:
+      return static_cast<CountingSafe96*>(this)->checkForPropagation(cr, idx, p, solver);
+    case ConstrType::COUNTINGSAFEARB:
+      return static_cast<CountingSafeArb*>(this)->checkForPropagation(cr, idx, p, solver);
+    case ConstrType::WATCHEDSAFE64:
+      return static_cast<WatchedSafe64*>(this)->checkForPropagation(cr, idx, p, solver);
+    case ConstrType::WATCHEDSAFE96:
+      return static_cast<WatchedSafe96*>(this)->checkForPropagation(cr, idx, p, solver);
+    case ConstrType::WATCHEDSAFEARB:
+      return static_cast<WatchedSafeArb*>(this)->checkForPropagation(cr, idx, p, solver);
+  }
+  assert(false);
+  return WatchStatus::KEEPWATCH;
+}
+
+void Constr::undoFalsified(int i) {
+  if (isMarkedForDelete()) return;  // watches of deleted constraints linger until propagation or GC drops them
+  switch (getType()) {
+    case ConstrType::COUNTING32:
+      return static_cast<Counting32*>(this)->undoFalsified(i);
+    case ConstrType::WATCHED32:
+      return static_cast<Watched32*>(this)->undoFalsified(i);
+    case ConstrType::COUNTINGSAFE64:
+      return static_cast<CountingSafe64*>(this)->undoFalsified(i);
+    case ConstrType::COUNTINGSAFE96:
+      return static_cast<CountingSafe96*>(this)->undoFalsified(i);
+    case ConstrType::COUNTINGSAFEARB:
+      return static_cast<CountingSafeArb*>(this)->undoFalsified(i);
+    case ConstrType::WATCHEDSAFE64:
+      return static_cast<WatchedSafe64*>(this)->undoFalsified(i);
+    case ConstrType::WATCHEDSAFE96:
+      return static_cast<WatchedSafe96*>(this)->undoFalsified(i);
+    case ConstrType::WATCHEDSAFEARB:
+      return static_cast<WatchedSafeArb*>(this)->undoFalsified(i);
+    default:
+      assert(false);  // clauses and cardinalities do not watch with idx>=INF
+  }
+}
+
 }  // namespace rs
@@ -39,6 +39,55 @@ namespace rs {
 
 enum class WatchStatus { DROPWATCH, KEEPWATCH, CONFLICTING };
 
+// concrete type of a Constr, kept in its header to dispatch the propagation hot path without virtual calls
+enum class ConstrType {
+  CLAUSE,
+  CARDINALITY,
+  COUNTING32,
+  WATCHED32,
+  COUNTINGSAFE64,
+  COUNTINGSAFE96,
+  COUNTINGSAFEARB,
+  WATCHEDSAFE64,
+  WATCHEDSAFE96,
+  WATCHEDSAFEARB
+};
+
+template <typename C>
+struct ConstrTypeOf;
+template <>
+struct ConstrTypeOf<Counting32> {
+  static constexpr ConstrType value = ConstrType::COUNTING32;
+};
+template <>
+struct ConstrTypeOf<Watched32> {
+  static constexpr ConstrType value = ConstrType::WATCHED32;
+};
+template <>
+struct ConstrTypeOf<CountingSafe64> {
+  static constexpr ConstrType value = ConstrType::COUNTINGSAFE64;
+};
+template <>
+struct ConstrTypeOf<CountingSafe96> {
+  static constexpr ConstrType value = ConstrType::COUNTINGSAFE96;
+};
+template <>
+struct ConstrTypeOf<CountingSafeArb> {
+  static constexpr ConstrType value = ConstrType::COUNTINGSAFEARB;
+};
+template <>
+struct ConstrTypeOf<WatchedSafe64> {
+  static constexpr ConstrType value = ConstrType::WATCHEDSAFE64;
+};
+template <>
+struct ConstrTypeOf<WatchedSafe96> {
+  static constexpr ConstrType value = ConstrType::WATCHEDSAFE96;
+};
+template <>
+struct ConstrTypeOf<WatchedSafeArb> {
+  static constexpr ConstrType value = ConstrType::WATCHEDSAFEARB;
+};
+
 class Solver;
 struct Constr {  // internal solver constraint optimized for fast propagation
   virtual size_t getMemSize() const = 0;
@@ -46,17 +95,20 @@ struct Constr {  // internal solver constraint optimized for fast propagation
   ID id;
   // NOTE: above attributes not strictly needed in cache-sensitive Constr, but it did not matter after testing
   struct {
-    unsigned unused : 1;
+    unsigned type : 4;
     unsigned origin : 4;
-    unsigned lbd : 27;
+    unsigned lbd : 22;
+    unsigned external : 1;
+    unsigned reason : 1;  // only set while reduceDB() runs
     unsigned markedfordel : 1;
     unsigned locked : 1;
     unsigned size : 30;
   } header;
   ActValC act;
+  static constexpr unsigned int maxLBD = 0x003FFFFF;
 
-  Constr(ID i, Origin o, bool lkd, unsigned int lngth) : id(i), act(0) {
-    header = {0, (unsigned int)o, 0x07FFFFFF, 0, lkd, lngth};
+  Constr(ID i, ConstrType t, Origin o, bool lkd, unsigned int lngth) : id(i), act(0) {
+    header = {(unsigned int)t, (unsigned int)o, maxLBD, 0, 0, 0, lkd, lngth};
   }
   virtual ~Constr() {}
   virtual void freeUp() = 0;  // poor man's destructor
@@ -64,24 +116,34 @@ struct Constr {  // internal solver constraint optimized for fast propagation
   unsigned int size() const { return header.size; }
   void setLocked(bool lkd) { header.locked = lkd; }
   bool isLocked() { return header.locked; }
+  ConstrType getType() const { return (ConstrType)header.type; }
   Origin getOrigin() const { return (Origin)header.origin; }
-  void setLBD(unsigned int lbd) { header.lbd = lbd; }
+  void setLBD(unsigned int lbd) { header.lbd = std::min(lbd, maxLBD); }
   unsigned int lbd() const { return header.lbd; }
+  void setExternal(bool ext) { header.external = ext; }
+  bool isExternal() const { return header.external; }
+  void setReason(bool rsn) { header.reason = rsn; }
+  bool isReason() const { return header.reason; }
   bool isMarkedForDelete() const { return header.markedfordel; }
   void markForDel() { header.markedfordel = 1; }
 
   virtual BigVal degree() const = 0;  // TODO: remove direct uses of these bigint methods, convert to ConstrExp instead
   virtual BigCoef coef(unsigned int i) const = 0;
   BigCoef largestCoef() const { return coef(0); };
+  // cheap approximations for bookkeeping and heuristics, avoiding the bigint methods above
+  virtual double degreeAsDouble() const = 0;
+  virtual double coefAsDouble(unsigned int i) const = 0;
+  double largestCoefAsDouble() const { return coefAsDouble(0); }
   virtual Lit lit(unsigned int i) const = 0;
 
   virtual void initializeWatches(CRef cr, Solver& solver) = 0;
-  virtual WatchStatus checkForPropagation(CRef cr, int& idx, Lit p, Solver& slvr) = 0;
-  virtual void undoFalsified(int i) = 0;
+  // dispatch on getType() to the final subclass, see Constr.cpp
+  WatchStatus checkForPropagation(CRef cr, int& idx, Lit p, Solver& slvr);
+  void undoFalsified(int i);
   virtual void resolveWith(CeSuper confl, Lit l, IntSet* actSet, Solver& solver) = 0;
 
   virtual CeSuper toExpanded(ConstrExpPools& cePools) const = 0;
-  virtual bool isSatisfiedAtRoot(const IntVecIt& level) const = 0;
+  virtual bool isSatisfiedAtRoot(const Levels& level) const = 0;
 
   std::ostream& operator<<(std::ostream& o) {
     for (size_t i = 0; i < size(); ++i) {
@@ -104,11 +166,13 @@ struct Clause final : public Constr {
 
   BigVal degree() const { return 1; }
   BigCoef coef([[maybe_unused]] unsigned int i) const { return 1; }
+  double degreeAsDouble() const { return 1; }
+  double coefAsDouble([[maybe_unused]] unsigned int i) const { return 1; }
   Lit lit(unsigned int i) const { return data[i]; }
 
   template <typename SMALL, typename LARGE>
   Clause(const ConstrExp<SMALL, LARGE>* constraint, bool locked, ID _id)
-      : Constr(_id, constraint->orig, locked, constraint->vars.size()) {
+      : Constr(_id, ConstrType::CLAUSE, constraint->orig, locked, constraint->vars.size()) {
     assert(_id > ID_Trivial);
     assert(constraint->vars.size() < INF);
     assert(constraint->getDegree() == 1);
@@ -128,7 +192,7 @@ struct Clause final : public Constr {
   void resolveWith(CeSuper confl, Lit l, IntSet* actSet, Solver& solver);
 
   CeSuper toExpanded(ConstrExpPools& cePools) const;
-  bool isSatisfiedAtRoot(const IntVecIt& level) const;
+  bool isSatisfiedAtRoot(const Levels& level) const;
 };
 
 struct Cardinality final : public Constr {
@@ -144,11 +208,13 @@ struct Cardinality final : public Constr {
 
   BigVal degree() const { return degr; }
   BigCoef coef([[maybe_unused]] unsigned int i) const { return 1; }
+  double degreeAsDouble() const { return degr; }
+  double coefAsDouble([[maybe_unused]] unsigned int i) const { return 1; }
   Lit lit(unsigned int i) const { return data[i]; }
 
   template <typename SMALL, typename LARGE>
   Cardinality(const ConstrExp<SMALL, LARGE>* constraint, bool locked, ID _id)
-      : Constr(_id, constraint->orig, locked, constraint->vars.size()),
+      : Constr(_id, ConstrType::CARDINALITY, constraint->orig, locked, constraint->vars.size()),
         watchIdx(0),
         degr(static_cast<unsigned int>(constraint->getDegree())),
         ntrailpops(-1) {
@@ -172,7 +238,7 @@ struct Cardinality final : public Constr {
   void resolveWith(CeSuper confl, Lit l, IntSet* actSet, Solver& solver);
 
   CeSuper toExpanded(ConstrExpPools& cePools) const;
-  bool isSatisfiedAtRoot(const IntVecIt& level) const;
+  bool isSatisfiedAtRoot(const Levels& level) const;
 };
 
 template <typename CF, typename DG>
@@ -190,11 +256,13 @@ struct Counting final : public Constr {
 
   BigVal degree() const { return degr; }
   BigCoef coef(unsigned int i) const { return data[i].c; }
+  double degreeAsDouble() const { return static_cast<double>(degr); }
+  double coefAsDouble(unsigned int i) const { return static_cast<double>(data[i].c); }
   Lit lit(unsigned int i) const { return data[i].l; }
 
   template <typename SMALL, typename LARGE>
   Counting(const ConstrExp<SMALL, LARGE>* constraint, bool locked, ID _id)
-      : Constr(_id, constraint->orig, locked, constraint->vars.size()),
+      : Constr(_id, ConstrTypeOf<Counting<CF, DG>>::value, constraint->orig, locked, constraint->vars.size()),
         watchIdx(0),
         ntrailpops(-1),
         degr(static_cast<DG>(constraint->getDegree())),
@@ -220,7 +288,7 @@ struct Counting final : public Constr {
 
   CePtr<ConstrExp<CF, DG>> expandTo(ConstrExpPools& cePools) const;
   CeSuper toExpanded(ConstrExpPools& cePools) const;
-  bool isSatisfiedAtRoot(const IntVecIt& level) const;
+  bool isSatisfiedAtRoot(const Levels& level) const;
 
   bool hasCorrectSlack(const Solver& solver);
 };
@@ -240,11 +308,13 @@ struct Watched final : public Constr {
 
   BigVal degree() const { return degr; }
   BigCoef coef(unsigned int i) const { return aux::abs(data[i].c); }
+  double degreeAsDouble() const { return static_cast<double>(degr); }
+  double coefAsDouble(unsigned int i) const { return static_cast<double>(aux::abs(data[i].c)); }
   Lit lit(unsigned int i) const { return data[i].l; }
 
   template <typename SMALL, typename LARGE>
   Watched(const ConstrExp<SMALL, LARGE>* constraint, bool locked, ID _id)
-      : Constr(_id, constraint->orig, locked, constraint->vars.size()),
+      : Constr(_id, ConstrTypeOf<Watched<CF, DG>>::value, constraint->orig, locked, constraint->vars.size()),
         watchIdx(0),
         ntrailpops(-1),
         degr(static_cast<DG>(constraint->getDegree())),
@@ -270,7 +340,7 @@ struct Watched final : public Constr {
 
   CePtr<ConstrExp<CF, DG>> expandTo(ConstrExpPools& cePools) const;
   CeSuper toExpanded(ConstrExpPools& cePools) const;
-  bool isSatisfiedAtRoot(const IntVecIt& level) const;
+  bool isSatisfiedAtRoot(const Levels& level) const;
 
   bool hasCorrectSlack(const Solver& solver);
   bool hasCorrectWatches(const Solver& solver);
@@ -291,11 +361,13 @@ struct CountingSafe final : public Constr {
 
   BigVal degree() const { return BigVal(*degr); }
   BigCoef coef(unsigned int i) const { return BigCoef(terms[i].c); }
+  double degreeAsDouble() const { return static_cast<double>(*degr); }
+  double coefAsDouble(unsigned int i) const { return static_cast<double>(terms[i].c); }
   Lit lit(unsigned int i) const { return terms[i].l; }
 
   template <typename SMALL, typename LARGE>
   CountingSafe(const ConstrExp<SMALL, LARGE>* constraint, bool locked, ID _id)
-      : Constr(_id, constraint->orig, locked, constraint->vars.size()),
+      : Constr(_id, ConstrTypeOf<CountingSafe<CF, DG>>::value, constraint->orig, locked, constraint->vars.size()),
         watchIdx(0),
         ntrailpops(-1),
         degr(new DG(static_cast<DG>(constraint->getDegree()))),
@@ -326,7 +398,7 @@ struct CountingSafe final : public Constr {
 
   CePtr<ConstrExp<CF, DG>> expandTo(ConstrExpPools& cePools) const;
   CeSuper toExpanded(ConstrExpPools& cePools) const;
-  bool isSatisfiedAtRoot(const IntVecIt& level) const;
+  bool isSatisfiedAtRoot(const Levels& level) const;
 
   bool hasCorrectSlack(const Solver& solver);
 };
@@ -346,11 +418,13 @@ struct WatchedSafe final : public Constr {
 
   BigVal degree() const { return BigVal(*degr); }
   BigCoef coef(unsigned int i) const { return BigCoef(aux::abs(terms[i].c)); }
+  double degreeAsDouble() const { return static_cast<double>(*degr); }
+  double coefAsDouble(unsigned int i) const { return static_cast<double>(aux::abs(terms[i].c)); }
   Lit lit(unsigned int i) const { return terms[i].l; }
 
   template <typename SMALL, typename LARGE>
   WatchedSafe(const ConstrExp<SMALL, LARGE>* constraint, bool locked, ID _id)
-      : Constr(_id, constraint->orig, locked, constraint->vars.size()),
+      : Constr(_id, ConstrTypeOf<WatchedSafe<CF, DG>>::value, constraint->orig, locked, constraint->vars.size()),
         watchIdx(0),
         ntrailpops(-1),
         degr(new DG(static_cast<DG>(constraint->getDegree()))),
@@ -381,7 +455,7 @@ struct WatchedSafe final : public Constr {
 
   CePtr<ConstrExp<CF, DG>> expandTo(ConstrExpPools& cePools) const;
   CeSuper toExpanded(ConstrExpPools& cePools) const;
-  bool isSatisfiedAtRoot(const IntVecIt& level) const;
+  bool isSatisfiedAtRoot(const Levels& level) const;
 
   bool hasCorrectSlack(const Solver& solver);
   bool hasCorrectWatches(const Solver& solver);
@@ -142,7 +142,7 @@ void ConstrExp<SMALL, LARGE>::remove(Var v) {
 }
 
 template <typename SMALL, typename LARGE>
-bool ConstrExp<SMALL, LARGE>::increasesSlack(const IntVecIt& level, Var v) const {
+bool ConstrExp<SMALL, LARGE>::increasesSlack(const Levels& level, Var v) const {
   return isTrue(level, v) || (!isFalse(level, v) && coefs[v] > 0);
 }
 
@@ -263,21 +263,7 @@ LARGE ConstrExp<SMALL, LARGE>::getCutoffVal() const {
 }
 
 template <typename SMALL, typename LARGE>
-Lit ConstrExp<SMALL, LARGE>::getLit(Lit l) const {  // NOTE: answer of 0 means coef 0
-  Var v = toVar(l);
-  assert(v < (Var)coefs.size());
-  return (coefs[v] == 0) ? 0 : (coefs[v] < 0 ? -v : v);
-}
-
-template <typename SMALL, typename LARGE>
-bool ConstrExp<SMALL, LARGE>::hasLit(Lit l) const {  // NOTE: answer of 0 means coef 0
-  Var v = toVar(l);
-  assert(v < (Var)coefs.size());
-  return (coefs[v] == 0) ? false : ((coefs[v] < 0) == (l < 0));
-}
-
-template <typename SMALL, typename LARGE>
-bool ConstrExp<SMALL, LARGE>::falsified(const IntVecIt& level, Var v) const {
+bool ConstrExp<SMALL, LARGE>::falsified(const Levels& level, Var v) const {
   assert(v > 0);
   assert((getLit(v) != 0 && !isFalse(level, getLit(v))) == (coefs[v] > 0 && !isFalse(level, v)) ||
          (coefs[v] < 0 && !isTrue(level, v)));
@@ -285,7 +271,7 @@ bool ConstrExp<SMALL, LARGE>::falsified(const IntVecIt& level, Var v) const {
 }
 
 template <typename SMALL, typename LARGE>
-LARGE ConstrExp<SMALL, LARGE>::getSlack(const IntVecIt& level) const {
+LARGE ConstrExp<SMALL, LARGE>::getSlack(const Levels& level) const {
   LARGE slack = -rhs;
   for (Var v : vars)
     if (increasesSlack(level, v)) slack += coefs[v];
@@ -293,7 +279,7 @@ LARGE ConstrExp<SMALL, LARGE>::getSlack(const IntVecIt& level) const {
 }
 
 template <typename SMALL, typename LARGE>
-bool ConstrExp<SMALL, LARGE>::hasNegativeSlack(const IntVecIt& level) const {
+bool ConstrExp<SMALL, LARGE>::hasNegativeSlack(const Levels& level) const {
   return getSlack(level) < 0;
 }
 
@@ -321,7 +307,7 @@ bool ConstrExp<SMALL, LARGE>::isInconsistency() const {
 }
 
 template <typename SMALL, typename LARGE>
-bool ConstrExp<SMALL, LARGE>::isSatisfied(const IntVecIt& level) const {
+bool ConstrExp<SMALL, LARGE>::isSatisfied(const Levels& level) const {
   LARGE eval = -degree;
   for (Var v : vars)
     if (isTrue(level, getLit(v))) eval += aux::abs(coefs[v]);
@@ -391,7 +377,7 @@ void ConstrExp<SMALL, LARGE>::weakenLast() {
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::logIfUnit(Lit l, const SMALL& c, const IntVecIt& level, const std::vector<int>& pos) {
+void ConstrExp<SMALL, LARGE>::logIfUnit(Lit l, const SMALL& c, const Levels& level, const Positions& pos) {
   if (isUnit(level, l))
     proofBuffer << (l < 0 ? "x" : "~x") << toVar(l) << " " << proofMult(c) << "+ ";
   else if (isUnit(level, -l))
@@ -399,7 +385,7 @@ void ConstrExp<SMALL, LARGE>::logIfUnit(Lit l, const SMALL& c, const IntVecIt& l
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::removeUnitsAndZeroes(const IntVecIt& level, const std::vector<int>& pos,
+void ConstrExp<SMALL, LARGE>::removeUnitsAndZeroes(const Levels& level, const Positions& pos,
                                                    bool doSaturation) {
   if (plogger) {
     for (Var v : vars) {
@@ -429,7 +415,7 @@ void ConstrExp<SMALL, LARGE>::removeUnitsAndZeroes(const IntVecIt& level, const
 }
 
 template <typename SMALL, typename LARGE>
-bool ConstrExp<SMALL, LARGE>::hasNoUnits(const IntVecIt& level) const {
+bool ConstrExp<SMALL, LARGE>::hasNoUnits(const Levels& level) const {
   for (Var v : vars)
     if (isUnit(level, v) || isUnit(level, -v)) return false;
   return true;
@@ -497,7 +483,7 @@ void ConstrExp<SMALL, LARGE>::invert() {
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::saturateAndFixOverflow(const IntVecIt& level, bool fullWeakening, int bitOverflow,
+void ConstrExp<SMALL, LARGE>::saturateAndFixOverflow(const Levels& level, bool fullWeakening, int bitOverflow,
                                                      int bitReduce, Lit asserting) {
   removeZeroes();
   SMALL largest = getLargestCoef();
@@ -602,7 +588,7 @@ void ConstrExp<SMALL, LARGE>::divideRoundUp(const LARGE& d) {
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::weakenDivideRound(const IntVecIt& level, Lit l, bool slackdiv, bool fullWeakening) {
+void ConstrExp<SMALL, LARGE>::weakenDivideRound(const Levels& level, Lit l, bool slackdiv, bool fullWeakening) {
   assert(getCoef(l) > 0);
   assert(getCoef(l) > getSlack(level));
 
@@ -617,7 +603,7 @@ void ConstrExp<SMALL, LARGE>::weakenDivideRound(const IntVecIt& level, Lit l, bo
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::weakenNonDivisibleNonFalsified(const IntVecIt& level, const LARGE& div,
+void ConstrExp<SMALL, LARGE>::weakenNonDivisibleNonFalsified(const Levels& level, const LARGE& div,
                                                              bool fullWeakening, Lit asserting) {
   assert(div > 0);
   if (div == 1) return;
@@ -669,7 +655,7 @@ bool ConstrExp<SMALL, LARGE>::divideByGCD() {
 
 // NOTE: only equivalence preserving operations!
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::postProcess(const IntVecIt& level, const std::vector<int>& pos, bool sortFirst,
+void ConstrExp<SMALL, LARGE>::postProcess(const Levels& level, const Positions& pos, bool sortFirst,
                                           Stats& sts) {
   removeUnitsAndZeroes(level, pos);  // NOTE: also saturates
   if (sortFirst) sortInDecreasingCoefOrder();
@@ -678,7 +664,7 @@ void ConstrExp<SMALL, LARGE>::postProcess(const IntVecIt& level, const std::vect
 }
 
 template <typename SMALL, typename LARGE>
-AssertionStatus ConstrExp<SMALL, LARGE>::isAssertingBefore(const IntVecIt& level, int lvl) const {
+AssertionStatus ConstrExp<SMALL, LARGE>::isAssertingBefore(const Levels& level, int lvl) const {
   assert(lvl >= 0);
   assert(isSaturated());
   SMALL largestCoef = 0;
@@ -702,7 +688,7 @@ AssertionStatus ConstrExp<SMALL, LARGE>::isAssertingBefore(const IntVecIt& level
 
 // @return: earliest decision level that propagates a variable
 template <typename SMALL, typename LARGE>
-int ConstrExp<SMALL, LARGE>::getAssertionLevel(const IntVecIt& level, const std::vector<int>& pos) const {
+int ConstrExp<SMALL, LARGE>::getAssertionLevel(const Levels& level, const Positions& pos) const {
   assert(hasNoZeroes());
   assert(isSortedInDecreasingCoefOrder());
   assert(hasNoUnits(level));
@@ -741,7 +727,7 @@ int ConstrExp<SMALL, LARGE>::getAssertionLevel(const IntVecIt& level, const std:
 
 // @post: preserves order after removeZeroes()
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::weakenNonImplied(const IntVecIt& level, const LARGE& slack, Stats& sts) {
+void ConstrExp<SMALL, LARGE>::weakenNonImplied(const Levels& level, const LARGE& slack, Stats& sts) {
   for (Var v : vars)
     if (coefs[v] != 0 && aux::abs(coefs[v]) <= slack && !falsified(level, v)) {
       weaken(v);
@@ -751,7 +737,7 @@ void ConstrExp<SMALL, LARGE>::weakenNonImplied(const IntVecIt& level, const LARG
 }
 
 template <typename SMALL, typename LARGE>
-bool ConstrExp<SMALL, LARGE>::weakenNonImplying(const IntVecIt& level, const SMALL& propCoef, const LARGE& slack,
+bool ConstrExp<SMALL, LARGE>::weakenNonImplying(const Levels& level, const SMALL& propCoef, const LARGE& slack,
                                                 Stats& sts) {
   LARGE slk = slack;
   assert(hasNoZeroes());
@@ -770,7 +756,7 @@ bool ConstrExp<SMALL, LARGE>::weakenNonImplying(const IntVecIt& level, const SMA
 
 // @post: preserves order after removeZeroes()
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::heuristicWeakening(const IntVecIt& level, const std::vector<int>& pos, Stats& sts) {
+void ConstrExp<SMALL, LARGE>::heuristicWeakening(const Levels& level, const Positions& pos, Stats& sts) {
   LARGE slk = getSlack(level);
   if (slk < 0) return;  // no propagation, no idea what to weaken
   assert(isSortedInDecreasingCoefOrder());
@@ -1033,7 +1019,7 @@ ID ConstrExp<SMALL, LARGE>::logProofLineWithInfo([[maybe_unused]] std::string&&
 
 // @pre: reducible to unit over v
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::logUnit(const IntVecIt& level, const std::vector<int>& pos, Var v_unit,
+void ConstrExp<SMALL, LARGE>::logUnit(const Levels& level, const Positions& pos, Var v_unit,
                                       const Stats& sts) {
   assert(plogger);
   // reduce to unit over v
@@ -1056,7 +1042,7 @@ void ConstrExp<SMALL, LARGE>::logUnit(const IntVecIt& level, const std::vector<i
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::logInconsistency(const IntVecIt& level, const std::vector<int>& pos, const Stats& sts) {
+void ConstrExp<SMALL, LARGE>::logInconsistency(const Levels& level, const Positions& pos, const Stats& sts) {
   assert(plogger);
   removeUnitsAndZeroes(level, pos);
   assert(hasNegativeSlack(level));
@@ -1077,8 +1063,8 @@ void ConstrExp<SMALL, LARGE>::toStreamAsOPB(std::ostream& o) const {
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::toStreamWithAssignment(std::ostream& o, const IntVecIt& level,
-                                                     const std::vector<int>& pos) const {
+void ConstrExp<SMALL, LARGE>::toStreamWithAssignment(std::ostream& o, const Levels& level,
+                                                     const Positions& pos) const {
   std::vector<Var> vs = vars;
   std::sort(vs.begin(), vs.end(), [](Var v1, Var v2) { return v1 < v2; });
   for (Var v : vs) {
@@ -1093,8 +1079,8 @@ void ConstrExp<SMALL, LARGE>::toStreamWithAssignment(std::ostream& o, const IntV
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::resolveWith(const Clause& c, Lit l, IntSet* actSet, const IntVecIt& level,
-                                          const std::vector<int>& pos) {
+void ConstrExp<SMALL, LARGE>::resolveWith(const Clause& c, Lit l, IntSet* actSet, const Levels& level,
+                                          const Positions& pos) {
   assert(getCoef(-l) > 0);
   stats.NADDEDLITERALS += c.size();
 
@@ -1139,7 +1125,7 @@ void ConstrExp<SMALL, LARGE>::resolveWith(const Clause& c, Lit l, IntSet* actSet
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::addUsedLitsToActiveSet(IntSet* actSet, Lit l, const IntVecIt& level) {
+void ConstrExp<SMALL, LARGE>::addUsedLitsToActiveSet(IntSet* actSet, Lit l, const Levels& level) {
   if (options.bumpLits) {
     actSet->add(l);
   } else {
@@ -1150,8 +1136,8 @@ void ConstrExp<SMALL, LARGE>::addUsedLitsToActiveSet(IntSet* actSet, Lit l, cons
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::resolveWith(const Cardinality& c, Lit l, IntSet* actSet, const IntVecIt& level,
-                                          const std::vector<int>& pos) {
+void ConstrExp<SMALL, LARGE>::resolveWith(const Cardinality& c, Lit l, IntSet* actSet, const Levels& level,
+                                          const Positions& pos) {
   assert(getCoef(-l) > 0);
   stats.NADDEDLITERALS += c.size();
 
@@ -1200,28 +1186,28 @@ void ConstrExp<SMALL, LARGE>::resolveWith(const Cardinality& c, Lit l, IntSet* a
 }
 
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::resolveWith(Ce32 c, Lit l, IntSet* actSet, const IntVecIt& Level,
-                                          const std::vector<int>& Pos) {
+void ConstrExp<SMALL, LARGE>::resolveWith(Ce32 c, Lit l, IntSet* actSet, const Levels& Level,
+                                          const Positions& Pos) {
   genericResolve(c, l, actSet, Level, Pos);
 }
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::resolveWith(Ce64 c, Lit l, IntSet* actSet, const IntVecIt& Level,
-                                          const std::vector<int>& Pos) {
+void ConstrExp<SMALL, LARGE>::resolveWith(Ce64 c, Lit l, IntSet* actSet, const Levels& Level,
+                                          const Positions& Pos) {
   genericResolve(c, l, actSet, Level, Pos);
 }
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::resolveWith(Ce96 c, Lit l, IntSet* actSet, const IntVecIt& Level,
-                                          const std::vector<int>& Pos) {
+void ConstrExp<SMALL, LARGE>::resolveWith(Ce96 c, Lit l, IntSet* actSet, const Levels& Level,
+                                          const Positions& Pos) {
   genericResolve(c, l, actSet, Level, Pos);
 }
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::resolveWith(Ce128 c, Lit l, IntSet* actSet, const IntVecIt& Level,
-                                          const std::vector<int>& Pos) {
+void ConstrExp<SMALL, LARGE>::resolveWith(Ce128 c, Lit l, IntSet* actSet, const Levels& Level,
+                                          const Positions& Pos) {
   genericResolve(c, l, actSet, Level, Pos);
 }
 template <typename SMALL, typename LARGE>
-void ConstrExp<SMALL, LARGE>::resolveWith(CeArb c, Lit l, IntSet* actSet, const IntVecIt& Level,
-                                          const std::vector<int>& Pos) {
+void ConstrExp<SMALL, LARGE>::resolveWith(CeArb c, Lit l, IntSet* actSet, const Levels& Level,
+                                          const Positions& Pos) {
   genericResolve(c, l, actSet, Level, Pos);
 }
 
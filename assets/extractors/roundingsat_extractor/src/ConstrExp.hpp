@@ -133,33 +133,33 @@ struct ConstrExpSuper {
   virtual void weaken(Var v) = 0;
   virtual void weakenLast() = 0;
 
-  virtual bool hasNegativeSlack(const IntVecIt& level) const = 0;
+  virtual bool hasNegativeSlack(const Levels& level) const = 0;
   virtual bool hasNegativeSlack(const IntSet& assumptions) const = 0;
   virtual bool isTautology() const = 0;
   virtual bool isInconsistency() const = 0;
-  virtual bool isSatisfied(const IntVecIt& level) const = 0;
+  virtual bool isSatisfied(const Levels& level) const = 0;
 
-  virtual void removeUnitsAndZeroes(const IntVecIt& level, const std::vector<int>& pos, bool doSaturation = true) = 0;
-  virtual bool hasNoUnits(const IntVecIt& level) const = 0;
+  virtual void removeUnitsAndZeroes(const Levels& level, const Positions& pos, bool doSaturation = true) = 0;
+  virtual bool hasNoUnits(const Levels& level) const = 0;
   virtual void removeZeroes() = 0;
   virtual bool hasNoZeroes() const = 0;
 
   virtual void saturate(const std::vector<Var>& vs, bool check = true) = 0;
   virtual void saturate(bool check = true) = 0;
   virtual bool isSaturated() const = 0;
-  virtual void saturateAndFixOverflow(const IntVecIt& level, bool fullWeakening, int bitOverflow, int bitReduce,
+  virtual void saturateAndFixOverflow(const Levels& level, bool fullWeakening, int bitOverflow, int bitReduce,
                                       Lit asserting) = 0;
   virtual void saturateAndFixOverflowRational(const std::vector<double>& lpSolution) = 0;
   virtual bool fitsInDouble() const = 0;
   virtual bool largestCoefFitsIn(int bits) const = 0;
 
-  virtual void weakenDivideRound(const IntVecIt& level, Lit l, bool slackdiv, bool fullWeakening) = 0;
+  virtual void weakenDivideRound(const Levels& level, Lit l, bool slackdiv, bool fullWeakening) = 0;
 
   virtual bool divideByGCD() = 0;
-  virtual void postProcess(const IntVecIt& level, const std::vector<int>& pos, bool sortFirst, Stats& sts) = 0;
-  virtual AssertionStatus isAssertingBefore(const IntVecIt& level, int lvl) const = 0;
-  virtual int getAssertionLevel(const IntVecIt& level, const std::vector<int>& pos) const = 0;
-  virtual void heuristicWeakening(const IntVecIt& level, const std::vector<int>& pos, Stats& sts) = 0;
+  virtual void postProcess(const Levels& level, const Positions& pos, bool sortFirst, Stats& sts) = 0;
+  virtual AssertionStatus isAssertingBefore(const Levels& level, int lvl) const = 0;
+  virtual int getAssertionLevel(const Levels& level, const Positions& pos) const = 0;
+  virtual void heuristicWeakening(const Levels& level, const Positions& pos, Stats& sts) = 0;
 
   virtual bool simplifyToCardinality(bool equivalencePreserving) = 0;
   virtual void simplifyToClause() = 0;
@@ -178,21 +178,21 @@ struct ConstrExpSuper {
   virtual ID logInput() = 0;
   virtual ID logProofLine() = 0;
   virtual ID logProofLineWithInfo([[maybe_unused]] std::string&& info, [[maybe_unused]] const Stats& sts) = 0;
-  virtual void logUnit(const IntVecIt& level, const std::vector<int>& pos, Var v_unit, const Stats& sts) = 0;
-  virtual void logInconsistency(const IntVecIt& level, const std::vector<int>& pos, const Stats& sts) = 0;
+  virtual void logUnit(const Levels& level, const Positions& pos, Var v_unit, const Stats& sts) = 0;
+  virtual void logInconsistency(const Levels& level, const Positions& pos, const Stats& sts) = 0;
 
   virtual void toStreamAsOPB(std::ostream& o) const = 0;
-  virtual void toStreamWithAssignment(std::ostream& o, const IntVecIt& level, const std::vector<int>& pos) const = 0;
-
-  virtual void resolveWith(Ce32 c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos) = 0;
-  virtual void resolveWith(Ce64 c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos) = 0;
-  virtual void resolveWith(Ce96 c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos) = 0;
-  virtual void resolveWith(Ce128 c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos) = 0;
-  virtual void resolveWith(CeArb c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos) = 0;
-  virtual void resolveWith(const Clause& c, Lit l, IntSet* actSet, const IntVecIt& Level,
-                           const std::vector<int>& Pos) = 0;
-  virtual void resolveWith(const Cardinality& c, Lit l, IntSet* actSet, const IntVecIt& Level,
-                           const std::vector<int>& Pos) = 0;
+  virtual void toStreamWithAssignment(std::ostream& o, const Levels& level, const Positions& pos) const = 0;
+
+  virtual void resolveWith(Ce32 c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos) = 0;
+  virtual void resolveWith(Ce64 c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos) = 0;
+  virtual void resolveWith(Ce96 c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos) = 0;
+  virtual void resolveWith(Ce128 c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos) = 0;
+  virtual void resolveWith(CeArb c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos) = 0;
+  virtual void resolveWith(const Clause& c, Lit l, IntSet* actSet, const Levels& Level,
+                           const Positions& Pos) = 0;
+  virtual void resolveWith(const Cardinality& c, Lit l, IntSet* actSet, const Levels& Level,
+                           const Positions& Pos) = 0;
 };
 
 template <typename CE>
@@ -214,18 +214,18 @@ struct ConstrExp final : public ConstrExpSuper {
 
  private:
   void remove(Var v);
-  bool increasesSlack(const IntVecIt& level, Var v) const;
+  bool increasesSlack(const Levels& level, Var v) const;
   LARGE calcDegree() const;
   LARGE calcRhs() const;
   bool testConstraint() const;
-  bool falsified(const IntVecIt& level, Var v) const;
+  bool falsified(const Levels& level, Var v) const;
   template <typename T>
   std::string proofMult(const T& mult) {
     std::stringstream ss;
     if (mult != 1) ss << mult << " * ";
     return ss.str();
   }
-  void logIfUnit(Lit l, const SMALL& c, const IntVecIt& level, const std::vector<int>& pos);
+  void logIfUnit(Lit l, const SMALL& c, const Levels& level, const Positions& pos);
 
  public:
   ConstrExp(ConstrExpPool<ConstrExp<SMALL, LARGE>>& cep);
@@ -264,8 +264,16 @@ struct ConstrExp final : public ConstrExpSuper {
   SMALL getLargestCoef() const;
   SMALL getSmallestCoef() const;
   LARGE getCutoffVal() const;
-  Lit getLit(Lit l) const;
-  bool hasLit(Lit l) const;
+  Lit getLit(Lit l) const {  // NOTE: answer of 0 means coef 0
+    Var v = toVar(l);
+    assert(v < (Var)coefs.size());
+    return (coefs[v] == 0) ? 0 : (coefs[v] < 0 ? -v : v);
+  }
+  bool hasLit(Lit l) const {
+    Var v = toVar(l);
+    assert(v < (Var)coefs.size());
+    return (coefs[v] == 0) ? false : ((coefs[v] < 0) == (l < 0));
+  }
 
   void addRhs(const LARGE& r);
   void addLhs(const SMALL& cf, Lit l);  // TODO: Term?
@@ -273,21 +281,21 @@ struct ConstrExp final : public ConstrExpSuper {
   void weaken(Var v);
   void weakenLast();
 
-  LARGE getSlack(const IntVecIt& level) const;
-  bool hasNegativeSlack(const IntVecIt& level) const;
+  LARGE getSlack(const Levels& level) const;
+  bool hasNegativeSlack(const Levels& level) const;
   LARGE getSlack(const IntSet& assumptions) const;
   bool hasNegativeSlack(const IntSet& assumptions) const;
   bool isTautology() const;
   bool isInconsistency() const;
-  bool isSatisfied(const IntVecIt& level) const;
+  bool isSatisfied(const Levels& level) const;
 
   /**
    * @brief Remove literals in reason with coeff 0 and weaken away literals that are unit constraints in our database.
    *
    * @post: preserves order of vars
    */
-  void removeUnitsAndZeroes(const IntVecIt& level, const std::vector<int>& pos, bool doSaturation = true);
-  bool hasNoUnits(const IntVecIt& level) const;
+  void removeUnitsAndZeroes(const Levels& level, const Positions& pos, bool doSaturation = true);
+  bool hasNoUnits(const Levels& level) const;
   // @post: mutates order of vars
   void removeZeroes();
   bool hasNoZeroes() const;
@@ -322,7 +330,7 @@ struct ConstrExp final : public ConstrExpSuper {
    * @post if overflow happened, all division until 2^bitReduce happened
    * @post the constraint remains conflicting or propagating on asserting
    */
-  void saturateAndFixOverflow(const IntVecIt& level, bool fullWeakening, int bitOverflow, int bitReduce, Lit asserting);
+  void saturateAndFixOverflow(const Levels& level, bool fullWeakening, int bitOverflow, int bitReduce, Lit asserting);
   /*
    * Fixes overflow for rationals
    * @post: saturated
@@ -385,7 +393,7 @@ struct ConstrExp final : public ConstrExpSuper {
    * @param fullWeakening If true, weaken literals completely. If false, weaken literals to biggest dividable
    * coefficient.
    */
-  void weakenDivideRound(const IntVecIt& level, Lit l, bool slackdiv, bool fullWeakening);
+  void weakenDivideRound(const Levels& level, Lit l, bool slackdiv, bool fullWeakening);
 
   /**
    * @brief Weaken the constraint such that each coefficient of the non falsified literal in the constraint are
@@ -397,17 +405,17 @@ struct ConstrExp final : public ConstrExpSuper {
    * coefficient.
    * @param asserting The literal to resolve over in the resolution step.
    */
-  void weakenNonDivisibleNonFalsified(const IntVecIt& level, const LARGE& div, bool fullWeakening, Lit asserting);
+  void weakenNonDivisibleNonFalsified(const Levels& level, const LARGE& div, bool fullWeakening, Lit asserting);
   void applyMIR(const LARGE& d, std::function<Lit(Var)> toLit);
 
   bool divideByGCD();
   // NOTE: only equivalence preserving operations!
-  void postProcess(const IntVecIt& level, const std::vector<int>& pos, bool sortFirst, Stats& sts);
-  AssertionStatus isAssertingBefore(const IntVecIt& level, int lvl) const;
+  void postProcess(const Levels& level, const Positions& pos, bool sortFirst, Stats& sts);
+  AssertionStatus isAssertingBefore(const Levels& level, int lvl) const;
   // @return: earliest decision level that propagates a variable
-  int getAssertionLevel(const IntVecIt& level, const std::vector<int>& pos) const;
+  int getAssertionLevel(const Levels& level, const Positions& pos) const;
   // @post: preserves order after removeZeroes()
-  void weakenNonImplied(const IntVecIt& level, const LARGE& slack, Stats& sts);
+  void weakenNonImplied(const Levels& level, const LARGE& slack, Stats& sts);
   /**
    * @brief Weaken literals that are falsified and have a small enough coefficient at the current level.
    *
@@ -415,9 +423,9 @@ struct ConstrExp final : public ConstrExpSuper {
    *
    * @todo: return modified slack?
    */
-  bool weakenNonImplying(const IntVecIt& level, const SMALL& propCoef, const LARGE& slack, Stats& sts);
+  bool weakenNonImplying(const Levels& level, const SMALL& propCoef, const LARGE& slack, Stats& sts);
   // @post: preserves order after removeZeroes()
-  void heuristicWeakening(const IntVecIt& level, const std::vector<int>& pos, Stats& sts);
+  void heuristicWeakening(const Levels& level, const Positions& pos, Stats& sts);
 
   // @post: preserves order
   template <typename T>
@@ -447,22 +455,22 @@ struct ConstrExp final : public ConstrExpSuper {
   ID logProofLine();
   ID logProofLineWithInfo([[maybe_unused]] std::string&& info, [[maybe_unused]] const Stats& sts);
   // @pre: reducible to unit over v
-  void logUnit(const IntVecIt& level, const std::vector<int>& pos, Var v_unit, const Stats& sts);
-  void logInconsistency(const IntVecIt& level, const std::vector<int>& pos, const Stats& sts);
+  void logUnit(const Levels& level, const Positions& pos, Var v_unit, const Stats& sts);
+  void logInconsistency(const Levels& level, const Positions& pos, const Stats& sts);
 
   void toStreamAsOPB(std::ostream& o) const;
-  void toStreamWithAssignment(std::ostream& o, const IntVecIt& level, const std::vector<int>& pos) const;
+  void toStreamWithAssignment(std::ostream& o, const Levels& level, const Positions& pos) const;
 
-  void resolveWith(Ce32 c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos);
-  void resolveWith(Ce64 c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos);
-  void resolveWith(Ce96 c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos);
-  void resolveWith(Ce128 c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos);
-  void resolveWith(CeArb c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos);
-  void resolveWith(const Clause& c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos);
-  void resolveWith(const Cardinality& c, Lit l, IntSet* actSet, const IntVecIt& Level, const std::vector<int>& Pos);
+  void resolveWith(Ce32 c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos);
+  void resolveWith(Ce64 c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos);
+  void resolveWith(Ce96 c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos);
+  void resolveWith(Ce128 c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos);
+  void resolveWith(CeArb c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos);
+  void resolveWith(const Clause& c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos);
+  void resolveWith(const Cardinality& c, Lit l, IntSet* actSet, const Levels& Level, const Positions& Pos);
 
  private:
-  void addUsedLitsToActiveSet(IntSet* actSet, Lit l, const IntVecIt& level);
+  void addUsedLitsToActiveSet(IntSet* actSet, Lit l, const Levels& level);
 
   /**
    * @brief Refine the reason constraint such that the slack of the resolvent with the conflict constraint over `l` is
@@ -476,8 +484,8 @@ struct ConstrExp final : public ConstrExpSuper {
    * @param Pos Index vector over variables where the variable was assigned on the trail.
    */
   template <typename CF, typename DG>
-  void refineConstrToNegativeSlackResolvent(CePtr<ConstrExp<CF, DG>> reason, Lit l, const IntVecIt& level,
-                                            const std::vector<int>& Pos) {
+  void refineConstrToNegativeSlackResolvent(CePtr<ConstrExp<CF, DG>> reason, Lit l, const Levels& level,
+                                            const Positions& Pos) {
     reason->removeUnitsAndZeroes(level, Pos);
     if (options.weakenNonImplying) reason->weakenNonImplying(level, reason->getCoef(l), reason->getSlack(level), stats);
     reason->saturateAndFixOverflow(level, (bool)options.weakenFull, options.bitsOverflow.get(),
@@ -495,8 +503,8 @@ struct ConstrExp final : public ConstrExpSuper {
   }
 
   template <typename CF, typename DG>
-  void genericResolve(CePtr<ConstrExp<CF, DG>> reason, Lit l, IntSet* actSet, const IntVecIt& level,
-                      const std::vector<int>& Pos) {
+  void genericResolve(CePtr<ConstrExp<CF, DG>> reason, Lit l, IntSet* actSet, const Levels& level,
+                      const Positions& Pos) {
     assert(getCoef(-l) > 0);
     stats.NADDEDLITERALS += reason->vars.size();
 
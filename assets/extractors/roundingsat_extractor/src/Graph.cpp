@@ -1,227 +1,586 @@
 #include "Graph.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace rs {
   Graph::Graph() {}
   
-  void Graph::init(ConstraintAllocator& ca, std::vector<CRef>& constraints, int nvars) {
+  void Graph::init(ConstraintAllocator& ca, std::vector<CRef>& constraints, int nvars, bool coefficientShares) {
     n_var = nvars;
-    nodes_amount = (n_var * 2) + constraints.size();
     n_constraints = constraints.size();
-    int var_offset = constraints.size() - 1;
-    int constraint_iter = 0;
-    for (CRef cr: constraints) {
-      const Constr& C = ca[cr];
+    nodes_amount = (n_var * 2) + n_constraints;
+    shares_by_coefficient = coefficientShares;
+    // first pass: node degrees, turned into row offsets
+    std::vector<int> offsets(nodes_amount + 1, 0);
+    slotId.resize(n_constraints);
+    for (int slot = 0; slot < n_constraints; ++slot) {
+      const Constr& C = ca[constraints[slot]];
+      slotId[slot] = C.id;
+      offsets[constraintNode(slot) + 1] = C.size();
+      for (unsigned int var_iter = 0; var_iter < C.size(); ++var_iter) ++offsets[literalNode(C.lit(var_iter)) + 1];
+    }
+    for (int node = 0; node < nodes_amount; ++node) offsets[node + 1] += offsets[node];
+    edges = offsets.back();
+    wasted = 0;
+    rowStart.assign(offsets.begin(), offsets.end() - 1);
+    rowEnd.assign(offsets.begin() + 1, offsets.end());
+    rowLimit = rowEnd;
+    // second pass: edges in both directions
+    adj.resize(edges);
+    weight.resize(edges);
+    std::vector<int> literal_fill(rowStart.begin(), rowStart.begin() + n_var * 2);
+    for (int slot = 0; slot < n_constraints; ++slot) {
+      const Constr& C = ca[constraints[slot]];
+      double normalizer = weightNormalizer(C);
+      int constraint_node = constraintNode(slot);
+      int constraint_fill = rowStart[constraint_node];
       for (unsigned int var_iter = 0; var_iter < C.size(); ++var_iter) {
-        Lit literal = C.lit(var_iter);
-        int var_index = (literal > 0) ? literal: abs(literal) * 2;
-        long double coef = static_cast<long double>(C.coef(var_iter));
-        long double degree = static_cast<long double>(C.degree());
-        adjacency_list[var_offset + var_index][constraint_iter] = coef/degree;
-        adjacency_list[constraint_iter][var_offset + var_index] = coef/degree;
+        int literal_node = literalNode(C.lit(var_iter));
+        EdgeWeight w = std::abs(C.coefAsDouble(var_iter)) / normalizer;
+        adj[constraint_fill] = literal_node;
+        weight[constraint_fill] = w;
+        ++constraint_fill;
+        int& fill = literal_fill[literal_node];
+        adj[fill] = constraint_node;
+        weight[fill] = w;
+        ++fill;
+      }
+    }
+    slotOf.clear();
+    pagerank.clear();
+    partition();
+  }
+
+  double Graph::weightNormalizer(const Constr& C) const {
+    if (!shares_by_coefficient) return C.degreeAsDouble();
+    double normalizer = 0;
+    for (unsigned int var_iter = 0; var_iter < C.size(); ++var_iter) {
+      normalizer += std::abs(C.coefAsDouble(var_iter));
+    }
+    return normalizer;
+  }
+
+  void Graph::partition() {
+    int threads = options.graphThreads.get();
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (threads == 1) {
+      pool.reset();
+    } else if (!pool || pool->size() != threads) {
+      pool = std::make_unique<WorkerPool>(threads);
+    }
+    // blocks for the power iterations, with at least 64k edges per block
+    int blocks = std::max(1, std::min<int>(threads, edges >> 16));
+    blockStart.assign(threads + 1, nodes_amount);
+    blockStart[0] = 0;
+    long long total_work = (long long)edges + nodes_amount;
+    long long work = 0;
+    for (int node = 0, block = 1; node < nodes_amount && block < blocks; ++node) {
+      if (work * blocks >= total_work * block) blockStart[block++] = node;
+      work += degree(node) + 1;
+    }
+  }
+
+  void Graph::update(ConstraintAllocator& ca, std::vector<CRef>& constraints, int firstAdded,
+                     const std::vector<ID>& removed, int nvars) {
+    if (nvars != n_var) {
+      // the literal nodes of the negative literals move, so rebuild, keeping the ranks for the warm start
+      std::vector<double> old_ranks;
+      old_ranks.swap(pagerank);
+      std::unordered_map<ID, int> old_node;
+      if (!old_ranks.empty()) {
+        for (int slot = 0; slot < n_constraints; ++slot) old_node[slotId[slot]] = constraintNode(slot);
+      }
+      int old_vars = n_var;
+      init(ca, constraints, nvars, shares_by_coefficient);
+      if (old_ranks.empty()) return;
+      pagerank.assign(nodes_amount, 1.0 / nodes_amount);
+      for (Var v = 1; v <= std::min(old_vars, n_var); ++v) {
+        pagerank[literalNode(v)] = old_ranks[v - 1];
+        pagerank[literalNode(-v)] = old_ranks[old_vars + v - 1];
+      }
+      for (int slot = 0; slot < n_constraints; ++slot) {
+        auto it = old_node.find(slotId[slot]);
+        if (it != old_node.end()) pagerank[constraintNode(slot)] = old_ranks[it->second];
+      }
+      return;
+    }
+    if (slotOf.empty()) {
+      for (int slot = 0; slot < n_constraints; ++slot) slotOf[slotId[slot]] = slot;
+    }
+    std::vector<int> dead_slots;
+    for (ID id : removed) {
+      auto it = slotOf.find(id);
+      if (it == slotOf.end()) continue;  // attached and removed since the previous update
+      dead_slots.push_back(it->second);
+      slotOf.erase(it);
+    }
+    if (!dead_slots.empty()) {
+      // the last live constraint nodes fill the holes, and the literal rows refer to their new nodes
+      std::sort(dead_slots.begin(), dead_slots.end());
+      std::vector<int> renamed(n_constraints);
+      for (int slot = 0; slot < n_constraints; ++slot) renamed[slot] = slot;
+      std::vector<bool> touched(n_var * 2, false);
+      auto touch = [&](int node) {
+        for (int e = rowStart[node]; e < rowEnd[node]; ++e) touched[adj[e]] = true;
+      };
+      for (int slot : dead_slots) {
+        int node = constraintNode(slot);
+        renamed[slot] = -1;
+        touch(node);
+        edges -= 2 * degree(node);
+        wasted += rowLimit[node] - rowStart[node];
+      }
+      int live = n_constraints - dead_slots.size();
+      int source = n_constraints;
+      for (int slot : dead_slots) {
+        if (slot >= live) break;
+        do --source;
+        while (renamed[source] < 0);
+        renamed[source] = slot;
+        int from = constraintNode(source);
+        int to = constraintNode(slot);
+        rowStart[to] = rowStart[from];
+        rowEnd[to] = rowEnd[from];
+        rowLimit[to] = rowLimit[from];
+        if (!pagerank.empty()) pagerank[to] = pagerank[from];
+        slotId[slot] = slotId[source];
+        slotOf[slotId[slot]] = slot;
+        touch(to);
+      }
+      for (int node = 0; node < n_var * 2; ++node) {
+        if (!touched[node]) continue;
+        int fill = rowStart[node];
+        for (int e = rowStart[node]; e < rowEnd[node]; ++e) {
+          int slot = renamed[adj[e] - n_var * 2];
+          if (slot < 0) continue;
+          adj[fill] = constraintNode(slot);
+          weight[fill] = weight[e];
+          ++fill;
+        }
+        rowEnd[node] = fill;
       }
-      constraint_iter++;
+      n_constraints = live;
+      nodes_amount = (n_var * 2) + n_constraints;
+      rowStart.resize(nodes_amount);
+      rowEnd.resize(nodes_amount);
+      rowLimit.resize(nodes_amount);
+      slotId.resize(n_constraints);
+      if (!pagerank.empty()) pagerank.resize(nodes_amount);
+    }
+    for (int i = firstAdded; i < (int)constraints.size(); ++i) {
+      const Constr& C = ca[constraints[i]];
+      int slot = n_constraints++;
+      int node = nodes_amount++;
+      slotId.push_back(C.id);
+      slotOf[C.id] = slot;
+      double normalizer = weightNormalizer(C);
+      int start = adj.size();
+      for (unsigned int var_iter = 0; var_iter < C.size(); ++var_iter) {
+        adj.push_back(literalNode(C.lit(var_iter)));
+        weight.push_back(std::abs(C.coefAsDouble(var_iter)) / normalizer);
+      }
+      rowStart.push_back(start);
+      rowEnd.push_back(adj.size());
+      rowLimit.push_back(adj.size());
+      for (int e = start; e < start + (int)C.size(); ++e) addEdge(adj[e], node, weight[e]);
+      edges += 2 * C.size();
+    }
+    if (!pagerank.empty()) pagerank.resize(nodes_amount, 1.0 / nodes_amount);
+    if (wasted > (int)adj.size() / 2) compact();
+    partition();
+  }
+
+  void Graph::addEdge(int node, int neighbour, EdgeWeight w) {
+    if (rowEnd[node] == rowLimit[node]) {
+      // the row is full: move it to the end of adj, with room to double
+      int length = degree(node);
+      int start = adj.size();
+      adj.resize(start + 2 * length + 4);
+      weight.resize(adj.size());
+      std::copy(adj.begin() + rowStart[node], adj.begin() + rowEnd[node], adj.begin() + start);
+      std::copy(weight.begin() + rowStart[node], weight.begin() + rowEnd[node], weight.begin() + start);
+      wasted += rowLimit[node] - rowStart[node];
+      rowStart[node] = start;
+      rowEnd[node] = start + length;
+      rowLimit[node] = adj.size();
+    }
+    adj[rowEnd[node]] = neighbour;
+    weight[rowEnd[node]] = w;
+    ++rowEnd[node];
+  }
+
+  void Graph::compact() {
+    // rows in node order again, the literal rows with some room to grow
+    std::vector<int> new_adj;
+    std::vector<EdgeWeight> new_weight;
+    new_adj.reserve(adj.size() - wasted);
+    new_weight.reserve(adj.size() - wasted);
+    for (int node = 0; node < nodes_amount; ++node) {
+      int start = new_adj.size();
+      new_adj.insert(new_adj.end(), adj.begin() + rowStart[node], adj.begin() + rowEnd[node]);
+      new_weight.insert(new_weight.end(), weight.begin() + rowStart[node], weight.begin() + rowEnd[node]);
+      rowStart[node] = start;
+      rowEnd[node] = new_adj.size();
+      if (node < n_var * 2) {
+        new_adj.resize(new_adj.size() + degree(node) / 8 + 4);
+        new_weight.resize(new_adj.size());
+      }
+      rowLimit[node] = new_adj.size();
+    }
+    adj.swap(new_adj);
+    weight.swap(new_weight);
+    wasted = 0;
+  }
+
+  double Graph::rowSum(int node, const double* x) const {
+    const int* neighbour = adj.data();
+    const EdgeWeight* w = weight.data();
+    int e = rowStart[node];
+    int end = rowEnd[node];
+#if defined(__AVX2__)
+    __m256d acc = _mm256_setzero_pd();
+    for (; e + 4 <= end; e += 4) {
+      __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(neighbour + e));
+      __m256d xs = _mm256_i32gather_pd(x, idx, 8);
+      __m256d ws = _mm256_cvtps_pd(_mm_loadu_ps(w + e));
+      acc = _mm256_add_pd(acc, _mm256_mul_pd(ws, xs));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    // four independent sums, so consecutive gathers do not wait on each other's additions
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (; e + 4 <= end; e += 4) {
+      s0 += w[e] * x[neighbour[e]];
+      s1 += w[e + 1] * x[neighbour[e + 1]];
+      s2 += w[e + 2] * x[neighbour[e + 2]];
+      s3 += w[e + 3] * x[neighbour[e + 3]];
+    }
+    double sum = (s0 + s1) + (s2 + s3);
+#endif
+    for (; e < end; ++e) sum += w[e] * x[neighbour[e]];
+    return sum;
+  }
+
+  template <typename F>
+  double Graph::sweep(const F& f) {
+    if (!pool || blockStart[1] == nodes_amount) {
+      double sum = 0;
+      for (int node = 0; node < nodes_amount; ++node) sum += f(node);
+      return sum;
+    }
+    std::vector<double> partial(pool->size(), 0);
+    pool->run([&](int block) {
+      double sum = 0;
+      for (int node = blockStart[block]; node < blockStart[block + 1]; ++node) sum += f(node);
+      partial[block] = sum;
+    });
+    double sum = 0;
+    for (double p : partial) sum += p;
+    return sum;
+  }
+
+  void Graph::setActivity(std::vector<ActValV>& activity, const std::vector<double>& centrality) const {
+    for (int l = 0; l < n_var; l++) {
+      activity[l + 1] = std::max(centrality[l], centrality[l + n_var]) * n_var * 2;
     }
   }
 
   void Graph::calculatePseudoBooleanCentrality(std::vector<ActValV>& activity, ConstraintAllocator& ca, std::vector<CRef>& constraints, int nvars) {
-    n_var = nvars;
-    nodes_amount = (n_var * 2);
-    std::vector<long double> ranks(nodes_amount, 0);
+    // only needs the literal nodes, so it works without init
+    std::vector<double> ranks(nvars * 2, 0);
     for (CRef cr: constraints) {
       const Constr& C = ca[cr];
-      long double degree = static_cast<long double>(C.degree());
+      double degree = C.degreeAsDouble();
       for (unsigned int var_iter = 0; var_iter < C.size(); ++var_iter) {
         Lit literal = C.lit(var_iter);
-        int var_index = (literal > 0) ? literal: abs(literal) * 2;
-        long double coef = static_cast<long double>(C.coef(var_iter));
-        ranks[var_index] += (coef/degree) * (1.0 / C.size());
+        int literal_index = (literal > 0 ? literal : nvars - literal) - 1;
+        double coef = C.coefAsDouble(var_iter);
+        ranks[literal_index] += (coef/degree) * (1.0 / C.size());
       }
     }
-    for (int l = 0; l < n_var; l++) {
-      activity[l + 1] = std::max(ranks[l], ranks[l + n_var]) * n_var * 2;
+    for (int l = 0; l < nvars; l++) {
+      activity[l + 1] = std::max(ranks[l], ranks[l + nvars]) * nvars * 2;
     }
   }
 
   void Graph::calculatePagerank(std::vector<ActValV>& activity) {
-    long double damping_factor = 0.85;
-    int max_iterations = 10;
-    std::vector<long double> ranks(nodes_amount, 1.0 / nodes_amount);
-    std::vector<long double> weights(nodes_amount);
-    // normalization    
-    for (const auto& [node, edges] : adjacency_list) {
-        double sum = 0;
-        for (const auto& [adj_node, adj_weight] : edges) {
-            sum += 1;
+    double damping_factor = 0.85;
+    // after an update, the ranks of the previous call are close to the new ones and few iterations remain
+    if (pagerank.size() != (size_t)nodes_amount) pagerank.assign(nodes_amount, 1.0 / nodes_amount);
+    std::vector<double>& ranks = pagerank;
+    std::vector<double> shares(nodes_amount);  // rank a node passes along each of its edges, before weighting
+    std::vector<double> new_shares(nodes_amount);
+    sweep([&](int node) {
+      shares[node] = degree(node) == 0 ? 0 : ranks[node] / degree(node);
+      return 0.0;
+    });
+    // ranking
+    double damping_value = (1 - damping_factor) / nodes_amount;
+    double delta = std::numeric_limits<double>::infinity();
+    for (iterations = 0; iterations < max_iterations && delta > tolerance * nodes_amount; ++iterations) {
+      delta = sweep([&](int node) {
+        if (degree(node) == 0) {
+          double old_rank = ranks[node];
+          ranks[node] = new_shares[node] = 0;
+          return old_rank;
         }
-        weights[node] = sum;
+        double rank = damping_factor * rowSum(node, shares.data()) + damping_value;
+        new_shares[node] = rank / degree(node);
+        double change = std::abs(rank - ranks[node]);
+        ranks[node] = rank;
+        return change;
+      });
+      shares.swap(new_shares);
     }
-    // ranking
-    long double damping_value = (1 - damping_factor) / nodes_amount;
-    for (int iteration = 0; iteration < max_iterations; ++iteration) {
-      std::vector<long double> new_ranks(nodes_amount, 0);
-      for (const auto& [node, edges] : adjacency_list) {
-        for (const auto& [adj_node, adj_weight] : edges) new_ranks[node] += (ranks[adj_node]* (adj_weight/weights[adj_node]));
-        new_ranks[node] = damping_factor * new_ranks[node];
-      }
-      for(const auto &pair : adjacency_list) {
-        new_ranks[pair.first] += damping_value;
-      }
-      ranks = new_ranks;
+    setActivity(activity, ranks);
+  }
+
+  void Graph::calculateWeightedPagerank(std::vector<ActValV>& activity, double tol) {
+    /*
+    * PageRank where a node passes its rank along its edges in proportion to their weights, and every node, also an
+    * isolated one, receives the damping share.
+    */
+    double damping_factor = 0.85;
+    std::vector<double> ranks(nodes_amount, 1.0 / nodes_amount);
+    std::vector<double> strength(nodes_amount);  // total weight of a node's edges
+    std::vector<double> shares(nodes_amount);    // rank a node passes along each unit of edge weight
+    std::vector<double> new_shares(nodes_amount);
+    sweep([&](int node) {
+      double sum = 0;
+      for (int e = rowStart[node]; e < rowEnd[node]; ++e) sum += weight[e];
+      strength[node] = sum;
+      shares[node] = sum == 0 ? 0 : ranks[node] / sum;
+      return 0.0;
+    });
+    double damping_value = (1 - damping_factor) / nodes_amount;
+    double delta = std::numeric_limits<double>::infinity();
+    for (iterations = 0; iterations < max_iterations && delta > tol * nodes_amount; ++iterations) {
+      delta = sweep([&](int node) {
+        double rank = damping_factor * rowSum(node, shares.data()) + damping_value;
+        new_shares[node] = strength[node] == 0 ? 0 : rank / strength[node];
+        double change = std::abs(rank - ranks[node]);
+        ranks[node] = rank;
+        return change;
+      });
+      shares.swap(new_shares);
     }
     for (int l = 0; l < n_var; l++) {
-      activity[l + 1] = std::max(ranks[l + n_constraints], ranks[l + n_constraints + n_var]) * n_var * 2;
+      activity[l + 1] = std::max(ranks[l], ranks[l + n_var]) * n_var;
     }
   }
 
   void Graph::calculateHITS(std::vector<ActValV>& activity) {
     /*
     * Uses authority as metric for variable picking.
-    *
+    * Both scores are kept at unit L2 norm.
     */
-    std::vector<long double> auth_index(nodes_amount, 1);
-    std::vector<long double> hub_index(nodes_amount, 1);
-    unsigned int max_iterations = 10;
-    for (unsigned int iteration = 0; iteration < max_iterations; iteration++) {
-      double norm = 0;
-      for(const auto& [node, adjacent_nodes] : adjacency_list) {
-        auth_index[node] = 0;
-        for (const auto& [adjacent_node, edge_weight]: adjacent_nodes) {
-            auth_index[node] += edge_weight * hub_index[adjacent_node];
-        }
-        norm += sqrt(auth_index[node]);
-      }
-      norm = sqrt(norm);
-      for(const auto& [node, adjacent_nodes] : adjacency_list) {
-        auth_index[node] /= norm;
-      }
-      norm = 0;
-      for(const auto& [node, adjacent_nodes] : adjacency_list) {
-        hub_index[node] = 0;
-        for (const auto& [adjacent_node, edge_weight]: adjacent_nodes) {
-            hub_index[node] += edge_weight * auth_index[adjacent_node];
-        }
-        norm += sqrt(hub_index[node]);
-      }
-      norm = sqrt(norm);
-      for(const auto& [node, adjacent_nodes] : adjacency_list) {
-        hub_index[node] /= norm;
-      }
-    }
-    for (int l = 0; l < n_var; l++) {
-      activity[l + 1] = std::max(auth_index[l + n_constraints], auth_index[l + n_constraints + n_var]) * n_var * 2;
+    std::vector<double> auth_index(nodes_amount, 0);
+    std::vector<double> hub_index(nodes_amount, 1);
+    std::vector<double> raw(nodes_amount);
+    // one half step: target = normalized (A * source), returns the L1 change of target
+    auto update = [&](std::vector<double>& target, const std::vector<double>& source) {
+      double norm = std::sqrt(sweep([&](int node) {
+        raw[node] = rowSum(node, source.data());
+        return raw[node] * raw[node];
+      }));
+      if (norm == 0) norm = 1;
+      return sweep([&](int node) {
+        double value = raw[node] / norm;
+        double change = std::abs(value - target[node]);
+        target[node] = value;
+        return change;
+      });
+    };
+    double delta = std::numeric_limits<double>::infinity();
+    for (iterations = 0; iterations < max_iterations && delta > tolerance * nodes_amount; ++iterations) {
+      delta = update(auth_index, hub_index);
+      delta += update(hub_index, auth_index);
     }
+    setActivity(activity, auth_index);
   }
 
   void Graph::calculateEigenvector(std::vector<ActValV>& activity) {
     /*
     * EigenVector centrality measure on variables
+    * Iterates with A + I, which has the same eigenvectors as A but, unlike A on this bipartite graph, a single
+    * dominant eigenvalue, so the iteration converges instead of alternating.
     */
 
-    std::vector<long double> centrality(nodes_amount);
-    unsigned int max_iterations = 10;
+    std::vector<double> centrality(nodes_amount, 1.0 / std::sqrt(nodes_amount));
+    std::vector<double> raw(nodes_amount);
 
-    for (unsigned int i = 0; i < max_iterations; i++) {
-      long double sum = 0;
-      std::vector<long double> new_centrality(nodes_amount, 0.0);
-      for (const auto& [node, adjacent_nodes]: adjacency_list) {
-        for(const auto& [adjacent_node, weight]: adjacent_nodes)
-          new_centrality[node] += weight * centrality[adjacent_node];
-        sum += new_centrality[node] * new_centrality[node];
-      }
-      long double norm = sqrt(sum);
-      for (int i = 0; i < new_centrality.size(); i++) new_centrality[i] /= norm;
-      centrality = new_centrality;
+    double delta = std::numeric_limits<double>::infinity();
+    for (iterations = 0; iterations < max_iterations && delta > tolerance * nodes_amount; ++iterations) {
+      double norm = std::sqrt(sweep([&](int node) {
+        raw[node] = rowSum(node, centrality.data()) + centrality[node];
+        return raw[node] * raw[node];
+      }));
+      if (norm == 0) norm = 1;
+      delta = sweep([&](int node) {
+        double value = raw[node] / norm;
+        double change = std::abs(value - centrality[node]);
+        centrality[node] = value;
+        return change;
+      });
     }
 
-    for (int l = 0; l < n_var; l++) {
-      activity[l + 1] = std::max(centrality[l + n_constraints], centrality[l + n_constraints + n_var]) * n_var * 2;
+    setActivity(activity, centrality);
+  }
+
+  Graph::ShortestPaths::ShortestPaths(int nodes)
+      : dist(nodes, std::numeric_limits<double>::infinity()), paths(nodes, 0), dependency(nodes, 0) {}
+
+  double Graph::pivotErrorBound(int pivots, double delta) const {
+    return std::sqrt(std::log(2 * nodes_amount / delta) / (2 * pivots));
+  }
+
+  std::vector<int> Graph::getSources(bool literalsOnly) const {
+    std::vector<int> sources(literalsOnly ? n_var * 2 : nodes_amount);
+    for (int i = 0; i < (int)sources.size(); ++i) sources[i] = i;
+    if (usePivots()) {
+      int pivots = options.graphPivots.get();
+      // pivots are drawn from all nodes, the first ones of a seeded shuffle, so that runs are reproducible
+      sources.resize(nodes_amount);
+      for (int i = 0; i < nodes_amount; ++i) sources[i] = i;
+      std::mt19937 rng(nodes_amount);
+      for (int i = 0; i < pivots; ++i) {
+        std::swap(sources[i], sources[std::uniform_int_distribution<int>(i, nodes_amount - 1)(rng)]);
+      }
+      sources.resize(pivots);
     }
+    return sources;
   }
 
-  std::vector<std::vector<long double>> Graph::getShortestPaths() {
+  void Graph::searchFrom(int source, ShortestPaths& sp, bool countPaths) const {
     /*
-    * Floyd-Warshall algorithm for all-pairs shortest paths
+    * Dijkstra from source with the edge weights as lengths, leaving the reached nodes in sp.settled.
+    * With countPaths, also counts the shortest paths to every node and accumulates the dependencies (Brandes).
     */
-    std::cout << "c Floyd-Warshall" << std::endl;
-    std::vector<std::vector<long double>> dist(nodes_amount, std::vector<long double>(nodes_amount, std::numeric_limits<long double>::max()));
-    for (int i = 0; i < nodes_amount; i++) {
-      dist[i][i] = 0;
+    for (int node : sp.settled) {
+      sp.dist[node] = std::numeric_limits<double>::infinity();
+      sp.paths[node] = sp.dependency[node] = 0;
     }
-    for (const auto& [node, adjacent_nodes]: adjacency_list) {
-      for (const auto& [adjacent_node, weight]: adjacent_nodes) {
-        dist[node][adjacent_node] = weight;
+    sp.settled.clear();
+    auto later = [](const std::pair<double, int>& x, const std::pair<double, int>& y) { return x.first > y.first; };
+    sp.dist[source] = 0;
+    sp.paths[source] = 1;
+    sp.heap.assign(1, {0, source});
+    while (!sp.heap.empty()) {
+      std::pop_heap(sp.heap.begin(), sp.heap.end(), later);
+      auto [d, node] = sp.heap.back();
+      sp.heap.pop_back();
+      if (d > sp.dist[node]) continue;  // outdated entry
+      sp.settled.push_back(node);
+      for (int e = rowStart[node]; e < rowEnd[node]; ++e) {
+        int next = adj[e];
+        double next_dist = d + weight[e];
+        if (next_dist < sp.dist[next]) {
+          sp.dist[next] = next_dist;
+          sp.paths[next] = sp.paths[node];
+          sp.heap.emplace_back(next_dist, next);
+          std::push_heap(sp.heap.begin(), sp.heap.end(), later);
+        } else if (countPaths && next_dist == sp.dist[next]) {
+          sp.paths[next] += sp.paths[node];
+        }
       }
     }
-    for (int k = 0; k < nodes_amount; k++) {
-      std::cout << "c Floyd-Warshall iteration " << k << std::endl;
-      for (int i = 0; i < nodes_amount; i++) {
-        for (int j = 0; j < nodes_amount; j++) {
-          if (dist[i][k] + dist[k][j] < dist[i][j]) {
-            dist[i][j] = dist[i][k] + dist[k][j];
-          }
-        }
+    if (!countPaths) return;
+    for (int i = sp.settled.size() - 1; i > 0; --i) {
+      int node = sp.settled[i];
+      double share = (1 + sp.dependency[node]) / sp.paths[node];
+      for (int e = rowStart[node]; e < rowEnd[node]; ++e) {
+        int prev = adj[e];
+        if (sp.dist[prev] + weight[e] == sp.dist[node]) sp.dependency[prev] += sp.paths[prev] * share;
       }
     }
-    return  dist;
+  }
+
+  template <typename F>
+  void Graph::forSources(const std::vector<int>& sources, const F& f) {
+    int threads = getThreads();
+    std::vector<ShortestPaths> buffers(threads, ShortestPaths(nodes_amount));
+    auto job = [&](int thread) {
+      for (int i = thread; i < (int)sources.size(); i += threads) f(sources[i], buffers[thread], thread);
+    };
+    if (pool) {
+      pool->run(job);
+    } else {
+      job(0);
+    }
   }
 
   void Graph::calculateClosenessCentrality(std::vector<ActValV>& activity) {
     /*
     * Closeness centrality measure on variables
+    * Uses the Wasserman-Faust variant, (r-1)/(N-1) times (r-1) over the distance sum, where r is the number of nodes
+    * in the component, so that nodes of small components do not look central.
     */
-    std::vector<std::vector<long double>> dist = getShortestPaths();
-    std::cout << "c Closeness centrality calculation" << std::endl;
-    std::vector<long double> centrality(nodes_amount, 0);
-    for (int i = n_constraints; i < nodes_amount; i++) {
-      for (int j = 0; j < nodes_amount; j++) {
-        if (i != j) {
-          centrality[i] += dist[i][j];
+    std::vector<int> sources = getSources(true);
+    iterations = sources.size();
+    std::vector<double> centrality(nodes_amount, 0);
+    if (!usePivots()) {
+      forSources(sources, [&](int source, ShortestPaths& sp, int) {
+        searchFrom(source, sp, false);
+        double sum = 0;
+        for (int node : sp.settled) sum += sp.dist[node];
+        double others = sp.settled.size() - 1;
+        centrality[source] = sum == 0 ? 0 : others / sum * others / (nodes_amount - 1);
+      });
+    } else {
+      // average distance to the pivots that reach a node, times the fraction of pivots that reach it
+      int threads = getThreads();
+      std::vector<std::vector<double>> dist_sum(threads, std::vector<double>(nodes_amount, 0));
+      std::vector<std::vector<int>> reached(threads, std::vector<int>(nodes_amount, 0));
+      forSources(sources, [&](int source, ShortestPaths& sp, int thread) {
+        searchFrom(source, sp, false);
+        for (int node : sp.settled) {
+          dist_sum[thread][node] += sp.dist[node];
+          ++reached[thread][node];
+        }
+      });
+      for (int node = 0; node < n_var * 2; ++node) {
+        double sum = 0;
+        int count = 0;
+        for (int thread = 0; thread < threads; ++thread) {
+          sum += dist_sum[thread][node];
+          count += reached[thread][node];
         }
+        centrality[node] = sum == 0 ? 0 : count / sum * count / sources.size();
       }
     }
-    for (int i = 0; i < nodes_amount; i++) {
-      centrality[i] = (nodes_amount - 1) / centrality[i];
-    }
-    for (int l = 0; l < n_var; l++) {
-      activity[l + 1] = std::max(centrality[l + n_constraints], centrality[l + n_constraints + n_var]) * n_var * 2;
-    }
+    setActivity(activity, centrality);
   }
 
   void Graph::calculateBetweennessCentrality(std::vector<ActValV>& activity) {
     /*
     * Betweenness centrality measure on variables
+    * Brandes' algorithm, normalized by the number of pairs of other nodes. With pivots, the dependencies of the
+    * pivots are scaled up to all sources.
     */
-
-    std::cout << "c Floyd-Warshall" << std::endl;
-    std::vector<long double> centrality(nodes_amount, 1);
-    std::vector<std::vector<long double>> dist(nodes_amount, std::vector<long double>(nodes_amount, std::numeric_limits<long double>::max()));
-    for (int i = 0; i < nodes_amount; i++) {
-      dist[i][i] = 0;
-    }
-    for (const auto& [node, adjacent_nodes]: adjacency_list) {
-      for (const auto& [adjacent_node, weight]: adjacent_nodes) {
-        dist[node][adjacent_node] = weight;
-      }
-    }
-    for (int k = 0; k < nodes_amount; k++) {
-      std::cout << "c Floyd-Warshall iteration " << k << std::endl;
-      for (int i = 0; i < nodes_amount; i++) {
-        for (int j = 0; j < nodes_amount; j++) {
-          if (dist[i][k] + dist[k][j] < dist[i][j]) {
-            dist[i][j] = dist[i][k] + dist[k][j];
-            centrality[k] = 1;
-          }
-          else if (dist[i][k] + dist[k][j] == dist[i][j]) {
-            centrality[k] += 1;
-          }
-        }
+    std::vector<int> sources = getSources(false);
+    iterations = sources.size();
+    int threads = getThreads();
+    std::vector<std::vector<double>> partial(threads, std::vector<double>(nodes_amount, 0));
+    forSources(sources, [&](int source, ShortestPaths& sp, int thread) {
+      searchFrom(source, sp, true);
+      for (int node : sp.settled) {
+        if (node != source) partial[thread][node] += sp.dependency[node];
       }
+    });
+    std::vector<double> centrality(nodes_amount, 0);
+    // every pair is counted from both ends, and each source stands for nodes_amount / #sources sources
+    double pairs = (double)(nodes_amount - 1) * (nodes_amount - 2);
+    double scale = pairs <= 0 ? 0 : (double)nodes_amount / sources.size() / pairs;
+    for (int thread = 0; thread < threads; ++thread) {
+      for (int node = 0; node < nodes_amount; ++node) centrality[node] += partial[thread][node] * scale;
     }
-    std::cout << "c Betweenness centrality calculation" << std::endl;
-    
-    for (int l = 0; l < n_var; l++) {
-      activity[l + 1] = std::max(centrality[l + n_constraints], centrality[l + n_constraints + n_var]) * n_var * 2;
-    }
+    setActivity(activity, centrality);
   }
 
   void Graph::calculateDegreeCentrality(std::vector<ActValV>& activity, bool weighted) {
@@ -229,24 +588,29 @@ namespace rs {
     * Degree centrality measure on variables
     */
     std::cout << "c Degree centrality calculation" << std::endl;
-    std::vector<long double> centrality(nodes_amount, 0);
+    std::vector<double> centrality(nodes_amount, 0);
     if (weighted)
       for (int i = 0; i < nodes_amount; i++) {
-        for (const auto& [adjacent_node, weight]: adjacency_list[i]) {
-          centrality[i] += weight;
-        }
+        for (int e = rowStart[i]; e < rowEnd[i]; ++e) centrality[i] += weight[e];
       }
     else
       for (int i = 0; i < nodes_amount; i++) {
-        centrality[i] = adjacency_list[i].size();
+        centrality[i] = degree(i);
       }
-    for (int l = 0; l < n_var; l++) {
-      activity[l + 1] = std::max(centrality[l + n_constraints], centrality[l + n_constraints + n_var]) * n_var * 2;
-    }
+    setActivity(activity, centrality);
   }
 
   void Graph::cleanMem() {
-    adjacency_list.clear();
+    rowStart = {};
+    rowEnd = {};
+    rowLimit = {};
+    adj = {};
+    weight = {};
+    slotId = {};
+    slotOf = {};
+    pagerank = {};
+    blockStart = {};
+    pool.reset();
   }
 
-}
\ No newline at end of file
+}
@@ -2,25 +2,85 @@
 
 #include "typedefs.hpp"
 #include "Constr.hpp"
+#include "WorkerPool.hpp"
+#include <memory>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace rs {
 
+using EdgeWeight = float;
 
 class Graph {
   /*
     Represents Formula as an uniderected graph.
+    Nodes 0..2n-1 are the literals, node v-1 is literal v and node n+v-1 is literal -v, followed by one node per
+    constraint. The adjacency is stored in compressed sparse row form: the neighbours of node i are
+    adj[rowStart[i]..rowEnd[i]), with the edge weights at the same positions in weight: coefficient over degree, or
+    with coefficientShares, coefficient over the sum of the constraint's coefficients.
+    After update, rows may leave room up to rowLimit, and adj may hold rows no node refers to any more.
   */
-  std::unordered_map<int,  std::unordered_map<int, long double> > adjacency_list;
+  std::vector<int> rowStart;
+  std::vector<int> rowEnd;
+  std::vector<int> rowLimit;
+  std::vector<int> adj;
+  std::vector<EdgeWeight> weight;
+  int edges = 0;   // entries of adj in use
+  int wasted = 0;  // entries of adj in rows that were removed or moved
+  bool shares_by_coefficient = false;
+  // The constraint of each constraint node, by ID, which stays the same when the constraint is moved in memory.
+  std::vector<ID> slotId;
+  std::unordered_map<ID, int> slotOf;  // filled by the first update
+  std::vector<double> pagerank;        // ranks of the last calculatePagerank, its warm start after an update
+  // The power iterations sweep the nodes in blocks of about equal edge counts, one per thread as long as each
+  // gets enough edges. The shortest path searches of the path-based measures are spread over all threads.
+  std::unique_ptr<WorkerPool> pool;
+  std::vector<int> blockStart;
+  // Buffers of one single-source shortest path search, reused for every source a thread handles.
+  struct ShortestPaths {
+    std::vector<double> dist;              // infinite for unreached nodes
+    std::vector<double> paths;             // number of shortest paths from the source
+    std::vector<double> dependency;        // Brandes' dependency of the source on each node
+    std::vector<int> settled;              // reached nodes in order of distance
+    std::vector<std::pair<double, int>> heap;
+    explicit ShortestPaths(int nodes);
+  };
+  int iterations = 0;
   int mode = 0;
   public:
     Graph();
-    void init(ConstraintAllocator& ca, std::vector<CRef>& constraints, int nvars);
+    void init(ConstraintAllocator& ca, std::vector<CRef>& constraints, int nvars, bool coefficientShares = false);
+    /*
+      Brings an initialized graph up to date with constraints, of which those from index firstAdded on were attached
+      since the previous init or update, and removed are the IDs of the constraints deleted since then. Only the
+      rows of the literals of these constraints are touched, unless the number of variables changed, and the next
+      calculatePagerank starts from the previous ranks.
+    */
+    void update(ConstraintAllocator& ca, std::vector<CRef>& constraints, int firstAdded, const std::vector<ID>& removed,
+                int nvars);
+    bool isResident() const { return !rowStart.empty(); }
     /* helpers */
+    int degree(int node) const { return rowEnd[node] - rowStart[node]; }
+    int getNodes() const { return nodes_amount; }
+    int getEdges() const { return edges; }
+    int getThreads() const { return pool ? pool->size() : 1; }
+    // power iterations, or shortest path searches, of the last centrality measure
+    int getIterations() const { return iterations; }
+    static constexpr int max_iterations = 100;
+    // power iterations stop once the L1 change of the scores is below tolerance per node, as in NetworkX
+    static constexpr double tolerance = 1e-6;
+    /*
+      Closeness and betweenness run one shortest path search from each source: from every literal node (closeness)
+      or every node (betweenness), or with --graph-pivots=k from k nodes drawn at random. With k pivots, every
+      normalized betweenness and every average distance over the diameter is within pivotErrorBound(k, delta) of
+      its exact value with probability at least 1 - delta (Hoeffding's inequality with a union bound over nodes).
+    */
+    double pivotErrorBound(int pivots, double delta) const;
     /* centrality measures */
     void calculatePseudoBooleanCentrality(std::vector<ActValV>& activity, ConstraintAllocator& ca, std::vector<CRef>& constraints, int nvars);
     void calculateClosenessCentrality(std::vector<ActValV>& activity);
     void calculatePagerank(std::vector<ActValV>& activity);
+    void calculateWeightedPagerank(std::vector<ActValV>& activity, double tol = tolerance);
     void calculateHITS(std::vector<ActValV>& activity);
     void calculateEigenvector(std::vector<ActValV>& activity);
     void calculateBetweennessCentrality(std::vector<ActValV>& activity);
@@ -31,10 +91,24 @@ class Graph {
       mode = newMode;
     }
   private:
-    std::vector<std::vector<long double>> getShortestPaths();
+    bool usePivots() const { return options.graphPivots.get() > 0 && options.graphPivots.get() < nodes_amount; }
+    std::vector<int> getSources(bool literalsOnly) const;
+    void searchFrom(int source, ShortestPaths& sp, bool countPaths) const;
+    template <typename F>
+    void forSources(const std::vector<int>& sources, const F& f);  // f(source, buffers, thread), sources in parallel
+    void setActivity(std::vector<ActValV>& activity, const std::vector<double>& centrality) const;
+    int literalNode(Lit l) const { return (l > 0 ? l : n_var - l) - 1; }
+    int constraintNode(int slot) const { return 2 * n_var + slot; }
+    double weightNormalizer(const Constr& C) const;
+    void addEdge(int node, int neighbour, EdgeWeight w);  // moves the row to the end of adj when it is full
+    void compact();                                       // drops the wasted entries of adj
+    void partition();                                     // sets up the threads and blocks
+    double rowSum(int node, const double* x) const;  // sum of x over the neighbours of node, weighted by the edges
+    template <typename F>
+    double sweep(const F& f);  // calls f on every node, in parallel, and returns the sum of its results
     int nodes_amount;
     int n_var;
     int n_constraints;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,317 @@
+/***********************************************************************
+Copyright (c) 2014-2020, Jan Elffers
+Copyright (c) 2019-2021, Jo Devriendt
+Copyright (c) 2020-2021, Stephan Gocht
+Copyright (c) 2014-2021, Jakob Nordström
+
+Parts of the code were copied or adapted from MiniSat.
+
+MiniSat -- Copyright (c) 2003-2006, Niklas Een, Niklas Sorensson
+           Copyright (c) 2007-2010  Niklas Sorensson
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+
+#include "LineReader.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "quit.hpp"
+
+#ifdef WITHZLIB
+#include <zlib.h>
+#endif
+#ifdef WITHLZMA
+#include <lzma.h>
+#endif
+#ifdef WITHBZIP2
+#include <bzlib.h>
+#endif
+
+namespace rs {
+
+// Streams the decompressed bytes of a compressed input, taken either from a mapped file or from a file descriptor.
+struct Decompressor {
+  const char* in = nullptr;  // compressed bytes not yet consumed
+  size_t avail = 0;
+  int fd = -1;
+  std::vector<char> inbuf;
+
+  virtual ~Decompressor() {}
+  // Writes up to n decompressed bytes to out; returns 0 at the end of the input.
+  virtual size_t read(char* out, size_t n) = 0;
+
+  // Makes more compressed input available; returns false at the end of the file.
+  bool refill() {
+    if (avail > 0) return true;
+    if (fd < 0) return false;
+    inbuf.resize(1 << 20);
+    ssize_t got;
+    do {
+      got = ::read(fd, inbuf.data(), inbuf.size());
+    } while (got < 0 && errno == EINTR);
+    if (got < 0) quit::exit_ERROR({"Could not read input: ", strerror(errno)});
+    in = inbuf.data();
+    avail = got;
+    return got > 0;
+  }
+};
+
+namespace {
+
+enum class Compression { NONE, GZIP, XZ, BZIP2 };
+
+Compression detectCompression(const char* p, size_t n) {
+  if (n >= 2 && (unsigned char)p[0] == 0x1f && (unsigned char)p[1] == 0x8b) return Compression::GZIP;
+  if (n >= 6 && memcmp(p, "\xfd" "7zXZ\0", 6) == 0) return Compression::XZ;
+  if (n >= 3 && memcmp(p, "BZh", 3) == 0) return Compression::BZIP2;
+  return Compression::NONE;
+}
+
+#ifdef WITHZLIB
+struct GzipDecompressor final : public Decompressor {
+  z_stream zs = {};
+  GzipDecompressor() {
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) quit::exit_ERROR({"Could not initialize gzip decompression."});
+  }
+  ~GzipDecompressor() { inflateEnd(&zs); }
+  size_t read(char* out, size_t n) override {
+    zs.next_out = reinterpret_cast<Bytef*>(out);
+    zs.avail_out = n;
+    while (zs.avail_out == n && refill()) {
+      zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+      zs.avail_in = avail;
+      int ret = inflate(&zs, Z_NO_FLUSH);
+      in = reinterpret_cast<const char*>(zs.next_in);
+      avail = zs.avail_in;
+      if (ret == Z_STREAM_END)
+        inflateReset(&zs);  // concatenated gzip members
+      else if (ret != Z_OK && ret != Z_BUF_ERROR)
+        quit::exit_ERROR({"Corrupt gzip input: ", zs.msg ? zs.msg : "unknown error"});
+    }
+    return n - zs.avail_out;
+  }
+};
+#endif
+
+#ifdef WITHLZMA
+struct XzDecompressor final : public Decompressor {
+  lzma_stream xs = LZMA_STREAM_INIT;
+  bool finished = false;
+  XzDecompressor() {
+    if (lzma_stream_decoder(&xs, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+      quit::exit_ERROR({"Could not initialize xz decompression."});
+  }
+  ~XzDecompressor() { lzma_end(&xs); }
+  size_t read(char* out, size_t n) override {
+    xs.next_out = reinterpret_cast<uint8_t*>(out);
+    xs.avail_out = n;
+    while (xs.avail_out == n && !finished) {
+      bool more = refill();
+      xs.next_in = reinterpret_cast<const uint8_t*>(in);
+      xs.avail_in = avail;
+      lzma_ret ret = lzma_code(&xs, more ? LZMA_RUN : LZMA_FINISH);
+      in = reinterpret_cast<const char*>(xs.next_in);
+      avail = xs.avail_in;
+      if (ret == LZMA_STREAM_END)
+        finished = true;
+      else if (ret != LZMA_OK)
+        quit::exit_ERROR({"Corrupt xz input."});
+    }
+    return n - xs.avail_out;
+  }
+};
+#endif
+
+#ifdef WITHBZIP2
+struct Bzip2Decompressor final : public Decompressor {
+  bz_stream bs = {};
+  Bzip2Decompressor() {
+    if (BZ2_bzDecompressInit(&bs, 0, 0) != BZ_OK) quit::exit_ERROR({"Could not initialize bzip2 decompression."});
+  }
+  ~Bzip2Decompressor() { BZ2_bzDecompressEnd(&bs); }
+  size_t read(char* out, size_t n) override {
+    bs.next_out = out;
+    bs.avail_out = n;
+    while (bs.avail_out == n && refill()) {
+      bs.next_in = const_cast<char*>(in);
+      bs.avail_in = avail;
+      int ret = BZ2_bzDecompress(&bs);
+      in = bs.next_in;
+      avail = bs.avail_in;
+      if (ret == BZ_STREAM_END) {  // concatenated bzip2 streams
+        char* next_out = bs.next_out;
+        unsigned int avail_out = bs.avail_out;
+        BZ2_bzDecompressEnd(&bs);
+        bs = {};
+        BZ2_bzDecompressInit(&bs, 0, 0);
+        bs.next_out = next_out;
+        bs.avail_out = avail_out;
+        if (avail_out == n) continue;  // nothing decompressed yet, go on with the next stream
+        break;
+      } else if (ret != BZ_OK) {
+        quit::exit_ERROR({"Corrupt bzip2 input."});
+      }
+    }
+    return n - bs.avail_out;
+  }
+};
+#endif
+
+std::unique_ptr<Decompressor> makeDecompressor(Compression c) {
+  switch (c) {
+    case Compression::GZIP:
+#ifdef WITHZLIB
+      return std::make_unique<GzipDecompressor>();
+#else
+      quit::exit_ERROR({"This build cannot read gzip compressed input (zlib was not found)."});
+#endif
+    case Compression::XZ:
+#ifdef WITHLZMA
+      return std::make_unique<XzDecompressor>();
+#else
+      quit::exit_ERROR({"This build cannot read xz compressed input (liblzma was not found)."});
+#endif
+    case Compression::BZIP2:
+#ifdef WITHBZIP2
+      return std::make_unique<Bzip2Decompressor>();
+#else
+      quit::exit_ERROR({"This build cannot read bzip2 compressed input (libbz2 was not found)."});
+#endif
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+LineReader::LineReader(const std::string& path) {
+  if (path.empty()) {
+    fd = STDIN_FILENO;
+  } else {
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) quit::exit_ERROR({"Could not open ", path});
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    void* m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (m != MAP_FAILED) {
+      madvise(m, st.st_size, MADV_SEQUENTIAL);
+      map = static_cast<const char*>(m);
+      mapSize = st.st_size;
+    }
+  }
+  buf.resize(1 << 20);
+  if (map != nullptr) {
+    Compression c = detectCompression(map, mapSize);
+    if (c == Compression::NONE) {
+      data = map;
+      size = mapSize;
+      return;
+    }
+    decompressor = makeDecompressor(c);
+    decompressor->in = map;
+    decompressor->avail = mapSize;
+  } else {
+    fill();  // the first raw bytes tell whether the input is compressed
+    Compression c = detectCompression(buf.data(), tail);
+    if (c == Compression::NONE) return;
+    decompressor = makeDecompressor(c);
+    decompressor->inbuf.assign(buf.data(), buf.data() + tail);
+    decompressor->in = decompressor->inbuf.data();
+    decompressor->avail = tail;
+    decompressor->fd = fd;
+    tail = 0;
+    eof = false;
+  }
+}
+
+LineReader::~LineReader() {
+  decompressor.reset();
+  if (map != nullptr) munmap(const_cast<char*>(map), mapSize);
+  if (fd > STDIN_FILENO) close(fd);
+}
+
+// Moves the unfinished line to the front of the window and reads behind it. Returns false at the end of the input.
+bool LineReader::fill() {
+  if (eof) return false;
+  memmove(buf.data(), buf.data() + head, tail - head);
+  tail -= head;
+  head = 0;
+  if (tail == buf.size()) buf.resize(2 * buf.size());  // line (or remaining input) longer than the window
+  ssize_t got;
+  if (decompressor) {
+    got = decompressor->read(buf.data() + tail, buf.size() - tail);
+  } else {
+    do {
+      got = read(fd, buf.data() + tail, buf.size() - tail);
+    } while (got < 0 && errno == EINTR);
+    if (got < 0) quit::exit_ERROR({"Could not read input: ", strerror(errno)});
+  }
+  if (got == 0) eof = true;
+  tail += got;
+  return true;
+}
+
+bool LineReader::startsWith(std::string_view prefix) {
+  if (data != nullptr) return std::string_view(data + offset, size - offset).substr(0, prefix.size()) == prefix;
+  while (tail - head < prefix.size() && fill()) {
+  }
+  return std::string_view(buf.data() + head, tail - head).substr(0, prefix.size()) == prefix;
+}
+
+std::string_view LineReader::remaining() {
+  if (data != nullptr) return std::string_view(data + offset, size - offset);
+  while (fill()) {
+  }
+  return std::string_view(buf.data() + head, tail - head);
+}
+
+bool LineReader::nextLine(const char*& begin, const char*& end) {
+  if (data != nullptr) {
+    if (offset >= size) return false;
+    begin = data + offset;
+    end = static_cast<const char*>(memchr(begin, '\n', size - offset));
+    if (end == nullptr) end = data + size;
+    offset = end - data + 1;
+  } else {
+    const char* nl;
+    while ((nl = static_cast<const char*>(memchr(buf.data() + head, '\n', tail - head))) == nullptr) {
+      if (!fill()) {
+        if (head == tail) return false;
+        nl = buf.data() + tail;  // last line without terminator
+        break;
+      }
+    }
+    begin = buf.data() + head;
+    end = nl;
+    head = std::min(tail, size_t(nl - buf.data()) + 1);
+    offset += end - begin + 1;
+  }
+  if (end > begin && end[-1] == '\r') --end;
+  return true;
+}
+
+}  // namespace rs
@@ -0,0 +1,78 @@
+/***********************************************************************
+Copyright (c) 2014-2020, Jan Elffers
+Copyright (c) 2019-2021, Jo Devriendt
+Copyright (c) 2020-2021, Stephan Gocht
+Copyright (c) 2014-2021, Jakob Nordström
+
+Parts of the code were copied or adapted from MiniSat.
+
+MiniSat -- Copyright (c) 2003-2006, Niklas Een, Niklas Sorensson
+           Copyright (c) 2007-2010  Niklas Sorensson
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rs {
+
+struct Decompressor;
+
+// Hands out the lines of an input file (or of standard input) as [begin,end) pointer ranges into a buffer, without
+// the line terminator. Regular files are memory mapped; other inputs are read in chunks into a window that is moved
+// forward, so a line stays valid only until the next call to nextLine. Input compressed with gzip, xz or bzip2 is
+// recognized by its magic bytes and decompressed into the window while it is read.
+class LineReader {
+  int fd = -1;
+  const char* map = nullptr;  // mapped file, compressed or not
+  size_t mapSize = 0;
+  const char* data = nullptr;  // mapped uncompressed file
+  size_t size = 0;
+  size_t offset = 0;  // bytes handed out so far
+  std::vector<char> buf;  // window over a non-mappable or compressed input
+  size_t head = 0, tail = 0;
+  bool eof = false;
+  std::unique_ptr<Decompressor> decompressor;
+
+  bool fill();
+
+ public:
+  // An empty path reads from standard input.
+  explicit LineReader(const std::string& path);
+  ~LineReader();
+  LineReader(const LineReader&) = delete;
+  LineReader& operator=(const LineReader&) = delete;
+
+  bool nextLine(const char*& begin, const char*& end);
+  size_t bytesRead() const { return offset; }
+
+  // Whether the input not yet handed out starts with the given bytes.
+  bool startsWith(std::string_view prefix);
+  // The input not yet handed out, as one contiguous range. Does not consume it.
+  std::string_view remaining();
+};
+
+}  // namespace rs
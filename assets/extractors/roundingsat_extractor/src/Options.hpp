@@ -182,6 +182,9 @@ struct Options {
   BoolOption propCard{"prop-card", "Optimized two-watched propagation for clauses", 1};
   BoolOption propIdx{"prop-idx", "Optimize index of watches during propagation", 1};
   BoolOption propSup{"prop-sup", "Avoid superfluous watch checks", 1};
+  ValOption<int> gcThreads{"gc-threads", "Threads updating the watches during garbage collection (0 means all cores)",
+                           1, "0 =< int", [](const int& x) -> bool { return x >= 0; }};
+  BoolOption caHugePages{"ca-hugepages", "Back the constraint database with transparent huge pages (Linux only)", 0};
   ValOption<double> lpPivotRatio{
       "lp", "Ratio of #pivots/#conflicts limiting LP calls (negative means infinite, 0 means no LP solving)", 0,
       "-1 =< float", [](const double& x) -> bool { return x >= -1; }};
@@ -245,6 +248,49 @@ struct Options {
   BoolOption cgCoreUpper{"cg-coreupper", "Exploit upper bound on cardinality cores", 1};
   BoolOption keepAll{"keepall", "Keep all learned constraints in the database indefinitely", 0};
 
+  ValOption<std::string> cacheFile{
+      "cache-file",
+      "Binary copy of the parsed formula: read instead of the instance if it was made from the same instance, "
+      "written otherwise. Cache files can also be given as the instance itself",
+      "", "/path/to/file", [](const std::string&) -> bool { return true; }};
+  VoidOption parseOnly{"parse-only", "Exit after reading the instance, reporting the parse time and throughput"};
+  VoidOption staticFeatures{"static-features",
+                             "Print the static feature vector of an OPB instance, computed while parsing it"};
+
+  ValOption<std::string> traceFile{
+      "trace-file",
+      "File to which the most recent decisions, restarts and solutions are written at exit, as a binary trace "
+      "(needs a build configured with -Dtrace=ON)",
+      "", "/path/to/file", [](const std::string&) -> bool { return true; }};
+  ValOption<int> traceSize{"trace-size", "Number of most recent events kept for --trace-file", 1 << 20, "1 =< int",
+                           [](const int& x) -> bool { return x >= 1; }};
+
+  ValOption<int> graphThreads{"graph-threads", "Threads used by the centrality heuristics (0 means all cores)", 1,
+                              "0 =< int", [](const int& x) -> bool { return x >= 0; }};
+  ValOption<int> graphPivots{"graph-pivots",
+                             "Sources sampled by the closeness and betweenness heuristics (0 means all nodes)", 64,
+                             "0 =< int", [](const int& x) -> bool { return x >= 0; }};
+  BoolOption graphPriority{"graph-priority",
+                           "Seed the variable activities with a weighted PageRank of the variable-constraint graph "
+                           "before search",
+                           0};
+  ValOption<int> graphRecalc{"graph-recalc",
+                             "Replace the variable activities by the PageRank of the current constraints every this "
+                             "many inprocessing phases (0 disables)",
+                             0, "0 =< int", [](const int& x) -> bool { return x >= 0; }};
+  BoolOption graphIncremental{"graph-incremental",
+                              "Keep the graph between centrality recalculations, updating it with the changed "
+                              "constraints and warm-starting the ranking",
+                              1};
+  VoidOption graphBench{"graph-bench",
+                        "Exit after reading the instance, reporting the run time of the centrality heuristics"};
+  ValOption<int> summaryConflicts{
+      "summary-conflicts", "Print the v2 summary features of each window of this many conflicts (0 disables)", 0,
+      "0 =< int", [](const int& x) -> bool { return x >= 0; }};
+  ValOption<double> summaryTime{"summary-time",
+                                "Print the v2 summary features of each window of this many seconds (0 disables)", 0,
+                                "0 =< float", [](const double& x) -> bool { return x >= 0; }};
+
   ValOption<int> timeout{"timeout", "time limit for running rs", -1,
                            "-1 =< int", [](const int& x) -> bool { return x >= -1; }};
 
@@ -258,7 +304,10 @@ struct Options {
       &bitsOverflow,  &bitsReduced,       &bitsLearned,    &bitsInput,     &cgEncoding,
       &cgBoosted,     &cgHybrid,          &cgIndCores,     &cgStrat,       &cgSolutionPhase,
       &cgReduction,   &cgResolveProp,     &cgDecisionCore, &cgCoreUpper,   &keepAll,
-      &timeout,
+      &timeout,       &staticFeatures,    &parseOnly,      &cacheFile,     &traceFile,
+      &traceSize,     &summaryConflicts,  &summaryTime,    &graphThreads,  &graphBench,
+      &graphPivots,   &graphPriority,     &graphRecalc,    &graphIncremental, &caHugePages,
+      &gcThreads,
   };
   std::unordered_map<std::string, Option*> name2opt;
 
@@ -34,6 +34,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Constr.hpp"
 #include "auxiliary.hpp"
 #include "globals.hpp"
+#include "quit.hpp"
 #include <fstream>
 
 
@@ -42,7 +43,7 @@ namespace rs {
 // ---------------------------------------------------------------------
 // Initialization
 
-Solver::Solver() : order_heap(activity) {
+Solver::Solver() : analyzeWidth(&Solver::analyzeAs<bigint, bigint>), order_heap(activity) {
   ca.capacity(1024 * 1024);  // 4MB
 }
 
@@ -50,18 +51,24 @@ void Solver::setNbVars(long long nvars, bool orig) {
   assert(nvars > 0);
   assert(nvars < INF);
   if (nvars <= n) return;
+  if (nvars >= Watch::maxVars)  // the watch encoding cannot tell larger literals from binary watches
+    quit::exit_ERROR({"Instances with ", std::to_string(nvars), " variables are not supported; the maximum is ",
+                      std::to_string(Watch::maxVars - 1), "."});
   aux::resizeIntMap(_adj, adj, nvars, resize_factor, {});
-  aux::resizeIntMap(_Level, Level, nvars, resize_factor, INF);
-  Pos.resize(nvars + 1, INF);
-  Reason.resize(nvars + 1, CRef_Undef);
-  activity.resize(nvars + 1, 1 / actLimitV);
+  std::vector<int>::iterator levels;
+  aux::resizeIntMap(_Level, levels, nvars, resize_factor, INF);
+  Level = Levels(_Level.data() + _Level.size() / 2);
+  states.resize(nvars + 1);
+  Pos = Positions(states.data());
+  Reason = Reasons(states.data());
+  activity.resize(nvars + 1, actInitV);
   phase.resize(nvars + 1);
   cePools.resize(nvars + 1);
   order_heap.resize(nvars + 1);
   for (Var v = n + 1; v <= nvars; ++v) phase[v] = -v, order_heap.insert(v);
   // if (lpSolver) lpSolver->setNbVariables(nvars + 1); // Currently, LP solver only reasons on formula constraints
   n = nvars;
-  stats.decisionStream << "v " << nvars << "\n";
+  stats.trace.record(Trace::VARS, nvars, stats.NCONFL);
   if (orig) {
     orig_n = n;
    
@@ -74,8 +81,23 @@ void Solver::setNbVars(long long nvars, bool orig) {
 
 
 void Solver::init() {
+  if (options.caHugePages) ca.adviseHugePages();
   if (!options.proofLog.get().empty()) logger = std::make_shared<Logger>(options.proofLog.get());
   cePools.initializeLogging(logger);
+  summary_stats.init();
+  // same width as getAnalysisCE
+  int bitsOverflow = options.bitsOverflow.get();
+  if (bitsOverflow == 0 || bitsOverflow > conflLimit128) {
+    analyzeWidth = &Solver::analyzeAs<bigint, bigint>;
+  } else if (bitsOverflow > conflLimit96) {
+    analyzeWidth = &Solver::analyzeAs<int128, int256>;
+  } else if (bitsOverflow > conflLimit64) {
+    analyzeWidth = &Solver::analyzeAs<int128, int128>;
+  } else if (bitsOverflow > conflLimit32) {
+    analyzeWidth = &Solver::analyzeAs<long long, int128>;
+  } else {
+    analyzeWidth = &Solver::analyzeAs<int, long long>;
+  }
 }
 
 void Solver::initLP([[maybe_unused]] const CeArb objective) {
@@ -84,7 +106,7 @@ void Solver::initLP([[maybe_unused]] const CeArb objective) {
   bool pureCNF = objective->vars.size() == 0;
   for (CRef cr : constraints) {
     if (!pureCNF) break;
-    pureCNF = (ca[cr].degree() == 1);
+    pureCNF = (ca[cr].degreeAsDouble() == 1);
   }
   if (pureCNF) return;
   lpSolver = std::make_shared<LpSolver>(*this, objective);
@@ -100,12 +122,9 @@ void Solver::vDecayActivity() { v_vsids_inc *= (1 / options.varDecay.get()); }
 void Solver::vBumpActivity(Var v) {
   assert(v > 0);
   if ((activity[v] += v_vsids_inc) > actLimitV) {  // Rescale
-    for (Var x = 1; x <= n; ++x) {
-      activity[x] /= actLimitV;
-      activity[x] /= actLimitV;
-    }
-    v_vsids_inc /= actLimitV;
-    v_vsids_inc /= actLimitV;
+    // a plain loop over the whole array, which the compiler vectorizes for float and double
+    for (ActValV& act : activity) act *= actRescaleV;
+    v_vsids_inc *= actRescaleV;
   }
   // Update heap with respect to new activity:
   if (order_heap.inHeap(v)) order_heap.percolateUp(v);
@@ -205,12 +224,31 @@ CeSuper Solver::runPropagation(bool onlyUnitPropagation) {
     std::vector<Watch>& ws = adj[-p];
     for (int it_ws = 0; it_ws < (int)ws.size(); ++it_ws) {
       int idx = ws[it_ws].idx;
-      if (idx < 0 && isTrue(Level, idx + INF)) {
-        assert(dynamic_cast<Clause*>(&(ca[ws[it_ws].cref])) != nullptr);
-        continue;
-      }  // blocked literal check
       CRef cr = ws[it_ws].cref;
-      WatchStatus wstat = checkForPropagation(cr, ws[it_ws].idx, -p);
+      WatchStatus wstat;
+      if (idx < 0) {
+        assert(dynamic_cast<Clause*>(&(ca[cr])) != nullptr);
+        if (idx < Watch::binaryBound) {  // implicit binary clause, no need to visit the constraint
+          Lit other = ws[it_ws].binaryLit();
+          if (isTrue(Level, other)) continue;
+          ++stats.NWATCHLOOKUPS;
+          if (isFalse(Level, other)) {
+            assert(ca[cr].isCorrectlyConflicting(*this));
+            wstat = WatchStatus::CONFLICTING;
+          } else {
+            ++stats.NPROPCLAUSE;
+            ++stats.NPROPCHECKS;
+            propagate(other, cr);
+            continue;
+          }
+        } else if (isTrue(Level, idx + INF)) {
+          continue;  // blocked literal check
+        } else {
+          wstat = checkForPropagation(cr, ws[it_ws].idx, -p);
+        }
+      } else {
+        wstat = checkForPropagation(cr, ws[it_ws].idx, -p);
+      }
       if (wstat == WatchStatus::DROPWATCH)
         aux::swapErase(ws, it_ws--);
       else if (wstat == WatchStatus::CONFLICTING) {  // clean up current level and stop propagation
@@ -234,7 +272,7 @@ CeSuper Solver::runPropagation(bool onlyUnitPropagation) {
         // stats.NLPENCGOMORY += C.getOrigin() == Origin::GOMORY;
         // stats.NLPENCLEARNEDFARKAS += C.getOrigin() == Origin::LEARNEDFARKAS;
         // stats.NLPENCFARKAS += C.getOrigin() == Origin::FARKAS;
-        summary_stats.addConflict(C.lbd(), stats);
+        summary_stats.addConflict(C.lbd(), C.isLocked());
 
         return C.toExpanded(cePools);
       }
@@ -297,15 +335,6 @@ CeSuper getAnalysisCE(const CeSuper& conflict, int bitsOverflow, ConstrExpPools&
   }
 }
 
-CeSuper Solver::prepareConflictConstraint(CeSuper conflict) {
-  conflict->removeUnitsAndZeroes(Level, Pos);
-  conflict->saturateAndFixOverflow(getLevel(), (bool)options.weakenFull, options.bitsOverflow.get(),
-                                   options.bitsReduced.get(), 0);
-  CeSuper confl = getAnalysisCE(conflict, options.bitsOverflow.get(), cePools);
-  conflict->reset();
-  return confl;
-}
-
 void Solver::assignActiveSet(CeSuper confl) {
   assert(actSet.isEmpty());  // will hold the literals that need their activity bumped
   for (Var v : confl->vars) {
@@ -347,22 +376,15 @@ void Solver::bumpLiteralActivity() {
   actSet.clear();
 }
 
-CeSuper Solver::analyze(CeSuper conflict) {
-  assert(conflict->hasNegativeSlack(Level));
-
-  if (logger) logger->logComment("Analyze", stats);
-  stats.NADDEDLITERALS += conflict->vars.size();
-
-  CeSuper confl = prepareConflictConstraint(conflict);
-  assignActiveSet(confl);
-
+template <typename SMALL, typename LARGE>
+void Solver::resolveConflict(ConstrExp<SMALL, LARGE>& ce, CeSuper& confl) {
   while (decisionLevel() > 0) {
     if (asynch_interrupt or stats.TLE() ) throw asynchInterrupt;
     Lit l = trail.back();
-    if (confl->hasLit(-l)) {
-      assert(confl->hasNegativeSlack(Level));
+    if (ce.hasLit(-l)) {
+      assert(ce.hasNegativeSlack(Level));
 
-      AssertionStatus status = confl->isAssertingBefore(Level, decisionLevel());
+      AssertionStatus status = ce.isAssertingBefore(Level, decisionLevel());
       // Conflict constraint could now be asserting after removing some assignments.
       if (status == AssertionStatus::ASSERTING) break;
       // Constraint is already falsified by before last decision on trail.
@@ -372,10 +394,38 @@ CeSuper Solver::analyze(CeSuper conflict) {
       }
 
       Constr& reasonC = getReasonConstraint(l);
-      reasonC.resolveWith(confl, l, &actSet, *this);
+      switch (reasonC.getType()) {  // clausal reasons need no expansion, so resolve them directly
+        case ConstrType::CLAUSE:
+          ce.resolveWith(static_cast<const Clause&>(reasonC), l, &actSet, Level, Pos);
+          break;
+        case ConstrType::CARDINALITY:
+          ce.resolveWith(static_cast<const Cardinality&>(reasonC), l, &actSet, Level, Pos);
+          break;
+        default:
+          reasonC.resolveWith(confl, l, &actSet, *this);
+      }
     }
     removeLastAssignment();
   }
+}
+
+template <typename SMALL, typename LARGE>
+CeSuper Solver::analyzeAs(CeSuper conflict) {
+  assert(conflict->hasNegativeSlack(Level));
+
+  if (logger) logger->logComment("Analyze", stats);
+  stats.NADDEDLITERALS += conflict->vars.size();
+
+  conflict->removeUnitsAndZeroes(Level, Pos);
+  conflict->saturateAndFixOverflow(getLevel(), (bool)options.weakenFull, options.bitsOverflow.get(),
+                                   options.bitsReduced.get(), 0);
+  CePtr<ConstrExp<SMALL, LARGE>> ce = cePools.take<SMALL, LARGE>();
+  conflict->copyTo(ce);
+  conflict->reset();
+  CeSuper confl = ce;
+  assignActiveSet(confl);
+
+  resolveConflict(*ce, confl);
   bumpLiteralActivity();
 
   assert(confl->hasNegativeSlack(Level));
@@ -488,17 +538,18 @@ CRef Solver::attachConstraint(CeSuper constraint, bool locked) {
 
   bool learned = (C.getOrigin() == Origin::LEARNED || C.getOrigin() == Origin::LEARNEDFARKAS ||
                   C.getOrigin() == Origin::FARKAS || C.getOrigin() == Origin::GOMORY);
+  double degree = C.degreeAsDouble();
   if (learned) {
     stats.LEARNEDLENGTHSUM += C.size();
-    stats.LEARNEDDEGREESUM += C.degree();
+    stats.LEARNEDDEGREESUM += degree;
   } else {
     stats.EXTERNLENGTHSUM += C.size();
-    stats.EXTERNDEGREESUM += C.degree();
+    stats.EXTERNDEGREESUM += degree;
   }
-  if (C.degree() == 1) {
+  if (degree == 1) {
     stats.NCLAUSESLEARNED += learned;
     stats.NCLAUSESEXTERN += !learned;
-  } else if (C.largestCoef() == 1) {
+  } else if (C.largestCoefAsDouble() == 1) {
     stats.NCARDINALITIESLEARNED += learned;
     stats.NCARDINALITIESEXTERN += !learned;
   } else {
@@ -589,6 +640,20 @@ std::pair<ID, ID> Solver::addInputConstraint(CeSuper ce) {
       input = ce->logAsAssumption();
     }
   }
+  if (bulkLoading && ce->orig == Origin::FORMULA) {
+    bulkLitCount.resize(2 * (n + 1), 0);
+    for (Var v : ce->vars) {
+      Lit l = ce->getLit(v);
+      if (l != 0) ++bulkLitCount[2 * v + (l < 0)];
+    }
+    bulkMemSize += Clause::getMemSize(ce->vars.size());
+    bulkStack.push_back(ce->toSimple());
+    return {input, ID_Undef};
+  }
+  return attachInputConstraint(ce, input, true);
+}
+
+std::pair<ID, ID> Solver::attachInputConstraint(CeSuper ce, ID input, bool propagate) {
   ce->postProcess(Level, Pos, true, stats);
   if (ce->isTautology()) {
     return {input, ID_Undef};  // already satisfied.
@@ -607,18 +672,21 @@ std::pair<ID, ID> Solver::addInputConstraint(CeSuper ce) {
   }
 
   CRef cr = attachConstraint(ce, true);
-  CeSuper confl = aux::timeCall<CeSuper>([&] { return runPropagation(true); }, stats.PROPTIME);
-  if (confl) {
-    assert(confl->hasNegativeSlack(Level));
-    if (options.verbosity.get() > 0) puts("c Input conflict");
-    if (logger) confl->logInconsistency(Level, Pos, stats);
-    assert(decisionLevel() == 0);
-    return {input, ID_Unsat};
+  if (propagate) {
+    CeSuper confl = aux::timeCall<CeSuper>([&] { return runPropagation(true); }, stats.PROPTIME);
+    if (confl) {
+      assert(confl->hasNegativeSlack(Level));
+      if (options.verbosity.get() > 0) puts("c Input conflict");
+      if (logger) confl->logInconsistency(Level, Pos, stats);
+      assert(decisionLevel() == 0);
+      return {input, ID_Unsat};
+    }
   }
   ID id = ca[cr].id;
   Origin orig = ca[cr].getOrigin();
   if (orig != Origin::FORMULA) {
     external[id] = cr;
+    ca[cr].setExternal(true);
   }
   if (lpSolver && (orig == Origin::FORMULA || orig == Origin::UPPERBOUND || orig == Origin::LOWERBOUND)) {
     lpSolver->addConstraint(cr, false, orig == Origin::UPPERBOUND, orig == Origin::LOWERBOUND);
@@ -645,12 +713,54 @@ std::pair<ID, ID> Solver::addUnitConstraint(Lit l, Origin orig) {
   return addConstraint(ConstrSimple32({{1, l}}, 1), orig);
 }
 
+void Solver::startBulkLoad() {
+  assert(decisionLevel() == 0);
+  bulkLoading = !logger;  // proof logs expect every input constraint to be attached as it is read
+}
+
+bool Solver::endBulkLoad() {
+  bulkLoading = false;
+  ca.capacity(std::min<unsigned long long>(ca.at + bulkMemSize, std::numeric_limits<CRefOfs>::max()));
+  for (Var v = 1; v < (Var)bulkLitCount.size() / 2; ++v) {
+    adj[v].reserve(adj[v].size() + bulkLitCount[2 * v]);
+    adj[-v].reserve(adj[-v].size() + bulkLitCount[2 * v + 1]);
+  }
+  bool consistent = true;
+  for (const std::unique_ptr<ConstrSimpleSuper>& c : bulkStack) {
+    if (attachInputConstraint(c->toExpanded(cePools), ID_Undef, false).second == ID_Unsat) {
+      consistent = false;
+      break;
+    }
+  }
+  bulkStack.clear();
+  bulkStack.shrink_to_fit();
+  bulkLitCount.clear();
+  bulkLitCount.shrink_to_fit();
+  bulkMemSize = 0;
+  if (!consistent) return false;
+  CeSuper confl = aux::timeCall<CeSuper>([&] { return runPropagation(true); }, stats.PROPTIME);
+  if (confl) {
+    assert(confl->hasNegativeSlack(Level));
+    if (options.verbosity.get() > 0) puts("c Input conflict");
+    return false;
+  }
+  return true;
+}
+
 void Solver::removeConstraint(Constr& C, [[maybe_unused]] bool override) {
   assert(override || !C.isLocked());
   assert(!C.isMarkedForDelete());
   assert(!external.count(C.id));
+  assert(!C.isExternal());
   C.markForDel();
   ca.wasted += C.getMemSize();
+  if (C.size() == 2) {  // implicit binary watches never look at the constraint, so drop them right away
+    for (unsigned int i = 0; i < 2; ++i) {
+      std::vector<Watch>& ws = adj[C.lit(i)];
+      for (int j = 0; j < (int)ws.size(); ++j)
+        if (ws[j].isBinary() && &ca[ws[j].cref] == &C) aux::swapErase(ws, j--);
+    }
+  }
 }
 
 void Solver::dropExternal(ID id, bool erasable, bool forceDelete) {
@@ -660,6 +770,7 @@ void Solver::dropExternal(ID id, bool erasable, bool forceDelete) {
   assert(old_it != external.end());
   Constr& constr = ca[old_it->second];
   external.erase(old_it);
+  constr.setExternal(false);
   constr.setLocked(!erasable);
   if (forceDelete) removeConstraint(constr);
 }
@@ -680,27 +791,61 @@ void Solver::setAssumptions(const IntSet& assumps) {
 void Solver::garbage_collect() {
   if (options.verbosity.get() > 0) puts("c GARBAGE COLLECT");
   garbage_calls++;
+  for (int i = 1; i < (int)constraints.size(); ++i) assert(constraints[i - 1].ofs < constraints[i].ofs);
+  // Until the constraints are moved, the id of every live constraint holds its forwarding offset, so each reference
+  // is updated with one read of the header it points to.
+  std::vector<ID> ids;
+  ids.reserve(constraints.size());
+  CRefOfs at = 0;
+  for (CRef cr : constraints) {
+    Constr& C = ca[cr];
+    ids.push_back(C.id);
+    C.id = at;
+    at += C.getMemSize();
+  }
+  auto forward = [&](CRef cr) { return CRef{(CRefOfs)ca[cr].id}; };
+
+  // watches of deleted constraints are dropped here as well
+  auto updateWatches = [&](Lit first, Lit last) {
+    for (Lit l = first; l < last; ++l) {
+      std::vector<Watch>& ws = adj[l];
+      for (int i = 0; i < (int)ws.size(); ++i) {
+        if (ca[ws[i].cref].isMarkedForDelete())
+          aux::swapErase(ws, i--);
+        else
+          ws[i].cref = forward(ws[i].cref);
+      }
+    }
+  };
+  int threads = options.gcThreads.get();
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  if (threads == 1) {
+    gcPool.reset();
+    updateWatches(-n, n + 1);
+  } else {
+    if (!gcPool || gcPool->size() != threads) gcPool = std::make_unique<WorkerPool>(threads);
+    long long lits = 2 * (long long)n + 1;
+    gcPool->run([&](int part) {
+      updateWatches(-n + lits * part / threads, -n + lits * (part + 1) / threads);
+    });
+  }
+  for (Var v = 1; v <= n; ++v) {  // reasons of unassigned variables may point to constraints deleted long ago
+    if (Reason[v] != CRef_Undef) Reason[v] = isUnknown(Pos, v) ? CRef_Undef : forward(Reason[v]);
+  }
+  for (auto& ext : external) ext.second = forward(ext.second);
+
   ca.wasted = 0;
   ca.at = 0;
-  std::unordered_map<uint32_t, CRef> crefmap;
-  for (int i = 1; i < (int)constraints.size(); ++i) assert(constraints[i - 1].ofs < constraints[i].ofs);
-  for (CRef& cr : constraints) {
-    uint32_t offset = cr.ofs;
-    size_t memSize = ca[cr].getMemSize();
+  for (size_t i = 0; i < constraints.size(); ++i) {
+    CRef& cr = constraints[i];
+    Constr& C = ca[cr];
+    C.id = ids[i];
+    size_t memSize = C.getMemSize();
     memmove(ca.memory + ca.at, ca.memory + cr.ofs, sizeof(uint32_t) * memSize);
     cr.ofs = ca.at;
     ca.at += memSize;
-    crefmap[offset] = cr;
-  }
-#define update_ptr(cr) cr = crefmap[cr.ofs];
-  for (Lit l = -n; l <= n; ++l) {
-    for (size_t i = 0; i < adj[l].size(); i++) update_ptr(adj[l][i].cref);
-  }
-  for (Var v = 1; v <= n; ++v) {
-    if (Reason[v] != CRef_Undef) update_ptr(Reason[v]);
   }
-  for (auto& ext : external) update_ptr(ext.second);
-#undef update_ptr
+  assert(ca.at == at);
 }
 
 // We assume in the garbage collection method that reduceDB() is the
@@ -711,14 +856,12 @@ void Solver::reduceDB() {
 
   size_t totalLearnts = 0;
   size_t promisingLearnts = 0;
+  for (Lit l : trail)
+    if (isPropagated(Reason, l)) ca[Reason[toVar(l)]].setReason(true);
   for (CRef& cr : constraints) {
     Constr& C = ca[cr];
-    if (C.isMarkedForDelete() || external.count(C.id)) continue;
-    bool isReason = false;
-    for (unsigned int i = 0; i < C.size() && !isReason; ++i) {
-      isReason = Reason[toVar(C.lit(i))] == cr;
-    }
-    if (isReason) continue;
+    if (C.isMarkedForDelete() || C.isExternal() || C.isReason()) continue;
+    assert(!external.count(C.id));
     if (C.isSatisfiedAtRoot(Level))
       removeConstraint(C, true);
     else if (!options.keepAll && !C.isLocked()) {
@@ -736,23 +879,25 @@ void Solver::reduceDB() {
     return ca[x].lbd() > ca[y].lbd() || (ca[x].lbd() == ca[y].lbd() && ca[x].act < ca[y].act);
   });
   for (size_t i = 0; i < std::min(totalLearnts / 2, learnts.size()); ++i) removeConstraint(ca[learnts[i]]);
-
-  for (Lit l = -n; l <= n; ++l)
-    for (int i = 0; i < (int)adj[l].size(); ++i) {
-      if (ca[adj[l][i].cref].isMarkedForDelete()) aux::swapErase(adj[l], i--);
-    }
+  for (Lit l : trail)
+    if (isPropagated(Reason, l)) ca[Reason[toVar(l)]].setReason(false);
+  // watches of the deleted constraints are dropped lazily, by checkForPropagation or by garbage_collect
 
   size_t i = 0;
   size_t j = 0;
+  size_t synced = 0;
   for (; i < constraints.size(); ++i) {
     Constr& c = ca[constraints[i]];
     if (c.isMarkedForDelete()) {
+      if (i < graphSynced) graphRemoved.push_back(c.id);
       c.freeUp();  // free up indirectly owned memory before implicitly deleting c during garbage collect
     } else {
+      synced += i < graphSynced;
       constraints[j++] = constraints[i];
     }
   }
   constraints.resize(j);
+  graphSynced = synced;
   if ((double)ca.wasted / (double)ca.at > 0.2) garbage_collect();
 }
 
@@ -837,92 +982,88 @@ void Solver::printWholeConstraints() {
   std::cout << "nbvars " << n << "jijija" << std::endl;
 }
 
-long double** Solver::buildGraph() {
-  int var_offset = constraints.size() - 1;
-  int node_length = constraints.size() + (n * 2);
-  long double** adjacency_matrix = new long double*[node_length];
-
-  for(int i = 0; i < node_length; ++i)
-    adjacency_matrix[i] = new long double[node_length];
-  for(int i = 0; i < node_length; ++i)
-    for(int j = 0; j < node_length; ++j)
-        adjacency_matrix[i][j] = 0;
-
-  int constraint_iter = 0;
-  for (CRef cr: constraints) {
-    const Constr& C = ca[cr];
-    double sum = 0.0;
-    for (unsigned int var_iter = 0; var_iter < C.size(); var_iter++) {
-      sum += abs(static_cast<long double>(C.coef(var_iter)));
-    }
-    for (unsigned int var_iter = 0; var_iter < C.size(); var_iter++) {
-      Lit literal = C.lit(var_iter);
-      int var_index = (literal > 0) ? literal: abs(literal) * 2;
-      long double normalized_coef = abs(static_cast<long double>(C.coef(var_iter))) / sum; 
-      adjacency_matrix[var_offset + var_index][constraint_iter] = normalized_coef;
-      adjacency_matrix[constraint_iter][var_offset + var_index] = normalized_coef;
-    }
-    constraint_iter++;
-  }
-  return adjacency_matrix;
-}
-
 void Solver::buildVariablePriority() {
   /*
     Use pagerank to add variable branching a headstart
   */
-  // intialization values
-  int node_length = constraints.size() + (n * 2);
-  long double damping_factor = 0.85;
-  long double epsilon = 1e-10;
-  int  max_iterations = 100;
-  std::vector<long double> ranks(node_length, 1.0 / node_length);
-  std::vector<long double> total_links(node_length);
-  // adjacency matrix of graph
-  long double** adj_matrix = buildGraph();
-  // normalization
-  for (int i = 0; i < node_length; ++i) {
-      double sum = 0;
-      for (int j = 0; j < node_length; ++j) {
-          sum += adj_matrix[i][j];
-      }
-      total_links[i] = sum;
-  }
+  graph.init(ca, constraints, n, true);
+  // converged far enough that the order of the variables is that of the exact ranks
+  graph.calculateWeightedPagerank(activity, 1e-9);
+  graph.cleanMem();
+  order_heap.recalculate();
+}
 
-  // ranking
-  for (int iteration = 0; iteration < max_iterations; ++iteration) {
-    std::vector<long double> new_ranks(node_length, 0);
-    for (int i = 0; i < node_length; ++i) {
-      for (int j = 0; j < node_length; ++j)
-        if (adj_matrix[j][i] > 0 && ranks[j] > 0) new_ranks[i] += (ranks[j]* (adj_matrix[j][i]/total_links[j]));
-      new_ranks[i] = damping_factor * new_ranks[i];
-    }
-    long double damping_value = (1 - damping_factor) / node_length;
-    for (int i = 0; i < node_length; ++i) {
-      new_ranks[i] += damping_value;
+void Solver::benchmarkCentrality() {
+  // wall-clock time, as the heuristics may run on several threads
+  auto secondsSince = [](std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+  auto start = std::chrono::steady_clock::now();
+  graph.init(ca, constraints, n);
+  printf("c graph nodes %d edges %d threads %d built in %g s\n", graph.getNodes(), graph.getEdges(),
+         graph.getThreads(), secondsSince(start));
+  auto bench = [&](const char* name, void (Graph::*measure)(std::vector<ActValV>&)) {
+    start = std::chrono::steady_clock::now();
+    (graph.*measure)(activity);
+    printf("c graph %s %g s %d iterations\n", name, secondsSince(start), graph.getIterations());
+  };
+  bench("pagerank", &Graph::calculatePagerank);
+  bench("hits", &Graph::calculateHITS);
+  bench("eigenvector", &Graph::calculateEigenvector);
+  bench("closeness", &Graph::calculateClosenessCentrality);
+  bench("betweenness", &Graph::calculateBetweennessCentrality);
+  int pivots = options.graphPivots.get();
+  if (pivots > 0 && pivots < graph.getNodes())
+    printf("c graph %d pivots: error at most %g with probability 0.9\n", pivots, graph.pivotErrorBound(pivots, 0.1));
+  // incremental updates: remove every tenth constraint, then attach them again, warm-starting from the ranks
+  graph.calculatePagerank(activity);
+  std::vector<CRef> kept;
+  std::vector<CRef> dropped;
+  std::vector<ID> droppedIds;
+  for (size_t i = 0; i < constraints.size(); ++i) {
+    if (i % 10 == 9) {
+      dropped.push_back(constraints[i]);
+      droppedIds.push_back(ca[constraints[i]].id);
+    } else {
+      kept.push_back(constraints[i]);
     }
-
-    ranks = new_ranks;
   }
-
-  for (int l = constraints.size(); l < (node_length + constraints.size())/2; l++) {
-    activity[l - constraints.size() + 1] = std::max(ranks[l], ranks[l + n]) * n;
-  }
-  order_heap.recalculate();
-
-  //deleting heap
-  for(int i = 0; i < node_length; ++i)
-      delete [] adj_matrix[i];
-  delete [] adj_matrix;
+  int firstAdded = kept.size();
+  start = std::chrono::steady_clock::now();
+  graph.update(ca, kept, firstAdded, droppedIds, n);
+  graph.calculatePagerank(activity);
+  printf("c graph removal of %d constraints %g s %d iterations\n", (int)dropped.size(), secondsSince(start),
+         graph.getIterations());
+  kept.insert(kept.end(), dropped.begin(), dropped.end());
+  start = std::chrono::steady_clock::now();
+  graph.update(ca, kept, firstAdded, {}, n);
+  graph.calculatePagerank(activity);
+  printf("c graph addition of %d constraints %g s %d iterations\n", (int)dropped.size(), secondsSince(start),
+         graph.getIterations());
+  graph.cleanMem();
+  start = std::chrono::steady_clock::now();
+  buildVariablePriority();
+  printf("c graph priority %g s %d iterations\n", secondsSince(start), graph.getIterations());
 }
 
 void Solver::recalculatVarPriorityGlobally() {
   if (constraints.size() > stats.NMAXCONSTRAINTS) stats.NMAXCONSTRAINTS = constraints.size();
   clock_t start, end;
   start = clock();
-  graph.init(ca, constraints, n);
-  graph.calculatePagerank(activity);
-  graph.cleanMem();
+  if (!options.graphIncremental) {
+    graph.init(ca, constraints, n);
+    graph.calculatePagerank(activity);
+    graph.cleanMem();
+  } else {
+    if (graph.isResident()) {
+      graph.update(ca, constraints, graphSynced, graphRemoved, n);
+    } else {
+      graph.init(ca, constraints, n);
+    }
+    graphSynced = constraints.size();
+    graphRemoved.clear();
+    graph.calculatePagerank(activity);
+  }
   order_heap.recalculate();
   end = clock();
   double time_taken = double(end - start) / double(CLOCKS_PER_SEC);
@@ -936,10 +1077,6 @@ void Solver::recalculatVarPriorityGlobally() {
 Lit Solver::pickBranchLit(bool lastSolPhase) {
   Var next = 0;
   // Activity based decision:
-  if((hasRestarted)) {
-    hasRestarted = false;
-    stats.decisionStream << "r" << std::endl;
-  }
   while (next == 0 || !isUnknown(Pos, next)) {
     if (order_heap.empty())
       return 0;
@@ -949,7 +1086,7 @@ Lit Solver::pickBranchLit(bool lastSolPhase) {
   assert(phase[0] == 0);
   assert(lastSol[0] == 0);
   Lit decision = (lastSolPhase && (int)lastSol.size() > next) ? lastSol[next] : phase[next];
-  stats.decisionStream << "d " << decision << std::endl;
+  stats.trace.record(Trace::DECISION, decision, stats.NCONFL);
   return decision;
 }
 
@@ -957,6 +1094,7 @@ Lit Solver::pickBranchLit(bool lastSolPhase) {
 
 void Solver::presolve() {
   firstRun = false;
+  if (options.graphPriority) buildVariablePriority();
   if (lpSolver) {
     aux::timeCall<void>([&] { lpSolver->inProcess(); }, stats.LPTOTALTIME);
   }
@@ -964,7 +1102,6 @@ void Solver::presolve() {
 
 SolveAnswer Solver::solve() {
   if (firstRun) {
-    stats.restartStream <<"LBD: "<< std::endl;
     presolve();
   }
   std::vector<int> assumptions_lim = {0};
@@ -1016,11 +1153,10 @@ SolveAnswer Solver::solve() {
       }
     } else {  // no conflict
       if (nconfl_to_restart <= 0) {
-        stats.restartStream << "R" << std::endl;
         backjumpTo(0);
         double rest_base = luby(options.lubyBase.get(), ++stats.NRESTARTS);
         nconfl_to_restart = (long long)rest_base * options.lubyMult.get();
-        hasRestarted = true;
+        stats.trace.record(Trace::RESTART, (int32_t)stats.NRESTARTS, stats.NCONFL);
         //        return {SolveState::RESTARTED, {}, lastSol}; // avoid this overhead for now
       }
       if (stats.NCONFL >= (stats.NCLEANUP + 1) * nconfl_to_reduce) {
@@ -1028,6 +1164,8 @@ SolveAnswer Solver::solve() {
         ++stats.NCLEANUP;
         reduceDB();
         while (stats.NCONFL >= stats.NCLEANUP * nconfl_to_reduce) nconfl_to_reduce += options.dbCleanInc.get();
+        if (options.graphRecalc.get() > 0 && stats.NCLEANUP % options.graphRecalc.get() == 0)
+          recalculatVarPriorityGlobally();
         if (lpSolver) aux::timeCall<void>([&] { lpSolver->inProcess(); }, stats.LPTOTALTIME);
         return {SolveState::INPROCESSED, {}, lastSol};
       }
@@ -1075,7 +1213,7 @@ SolveAnswer Solver::solve() {
         lastSol[0] = 0;
         for (Var v = 1; v <= getNbVars(); ++v) lastSol[v] = isTrue(Level, v) ? v : -v;
         backjumpTo(0);
-        stats.restartStream << "S" << std::endl;
+        stats.trace.record(Trace::SOLUTION, 0, stats.NCONFL);
         return {SolveState::SAT, {}, lastSol};
       }
       decide(next);
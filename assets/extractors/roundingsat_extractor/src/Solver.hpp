@@ -31,6 +31,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
+#include <array>
 #include <random>
 #include <memory>
 #include "Constr.hpp"
@@ -39,6 +40,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Options.hpp"
 #include "typedefs.hpp"
 #include "Graph.hpp"
+#include "WorkerPool.hpp"
 
 namespace rs {
 
@@ -52,61 +54,146 @@ struct SolveAnswer {
   std::vector<Lit>& solution;
 };
 
+// Search features over the conflicts found by runPropagation. printSummary prints two groups for the whole run:
+// - the CSV line keeps the column definitions of the original extractor, which the trained models read: per conflict,
+//   the sums of the cumulative Stats counters are extended (in doubles, so they cannot overflow);
+// - a "c features-v2" line with rates taken from per-conflict counts and moving averages. The same v2 features are
+//   printed for consecutive windows of --summary-conflicts conflicts or --summary-time seconds.
 struct SummaryStats {
-  double lbd_sum = 0;
-  int ndecide_sum = 0;
-  int nprop_sum = 0;
-  int nconflict_total = 0;  // Also serves as conflict count
-  int nclauses_learned_sum = 0;
-  int ntrailpops_sum = 0;
-  int nrestarts_sum = 0;
-  int learned_length_sum = 0;
-  int current_upper_bound_sum = 0;
-  
-  // Counters
-  int conflict_count = 0;
-  bool isOpt = false;
-  
-
-  void addConflict(double lbd, const Stats& stats) {
-      lbd_sum += lbd;
-      ndecide_sum += stats.NDECIDE;
-      nprop_sum += stats.NPROP;
-      nconflict_total += stats.NCONFL;
-      nclauses_learned_sum += stats.NCLAUSESLEARNED;
-      ntrailpops_sum += stats.NTRAILPOPS;
-      nrestarts_sum += stats.NRESTARTS;
-      learned_length_sum += (stats.NCLAUSESLEARNED > 0 ? stats.LEARNEDLENGTHSUM : 0);
-      current_upper_bound_sum += stats.currentUpperBound;
-      conflict_count++;
+  static constexpr int nFeatures = 11;
+  static constexpr double emaWeight = 1.0 / 1024;  // weight of the latest conflict in the moving averages
+  static constexpr unsigned int legacyLockedLBD = 0x07FFFFFF;  // placeholder LBD of the original 27-bit field
+
+ private:
+  struct Legacy {  // sums over conflicts of the cumulative counters, as in the original summary line
+    long long conflicts = 0;
+    double lbdSum = 0, ndecide = 0, nprop = 0, nconfl = 0, nclauseslearned = 0, ntrailpops = 0, nrestarts = 0,
+           learnedLengthSum = 0;
+  };
+
+  struct Mark {  // counter values at the start of a window
+    long long conflicts = 0, lbdCount = 0;
+    double lbdSum = 0;
+    long long ndecide = 0, nprop = 0, ntrailpops = 0, nclauseslearned = 0, nlearned = 0, nrestarts = 0;
+    double learnedLengthSum = 0;
+  };
+
+  Legacy legacy;
+  long long conflicts = 0;
+  long long lbdCount = 0;  // conflict constraints with a computed LBD, i.e., not locked formula constraints
+  double lbdSum = 0;
+  double decideEma = 0;  // decisions between consecutive conflicts
+  double propEma = 0;    // propagations between consecutive conflicts
+  long long lastDecide = 0, lastProp = 0;
+
+  Mark windowStart;
+  long long nextConflictMark = 0;
+  double nextTimeMark = 0;
+
+  static double ratio(double a, double b) { return b == 0 ? 0 : a / b; }
+
+  Mark mark() const {
+    return {conflicts,
+            lbdCount,
+            lbdSum,
+            stats.NDECIDE,
+            stats.NPROP,
+            stats.NTRAILPOPS,
+            stats.NCLAUSESLEARNED,
+            stats.NCLAUSESLEARNED + stats.NCARDINALITIESLEARNED + stats.NGENERALSLEARNED,
+            stats.NRESTARTS,
+            static_cast<double>(stats.LEARNEDLENGTHSUM)};
   }
 
-  template <typename LARGE>
-  void printSummary(std::ostream& out, int opt, const LARGE& bestObjVal) const {
-    out << (opt == 1 ? "OPT" : (opt == 2 ? "UNSAT" : "UNK")) << ","
-        << bestObjVal << ","
-        << (conflict_count == 0 ? 0.0 : lbd_sum / conflict_count) << ","
-        << (conflict_count == 0 ? 0.0 : static_cast<double>(ntrailpops_sum) / conflict_count) << ","
-        << (conflict_count == 0 ? 0.0 : static_cast<double>(ndecide_sum) / nconflict_total) << ","
-        << (conflict_count == 0 || nconflict_total == 0 ? 0.0 : static_cast<double>(nprop_sum) / nconflict_total) << ","
-        << (conflict_count == 0 || ndecide_sum == 0 ? 0.0 : static_cast<double>(nprop_sum) / ndecide_sum) << ","
-        << (conflict_count == 0 ? 0.0 : static_cast<double>(ndecide_sum) / conflict_count) << ", "
-        << (conflict_count == 0 ? 0.0 : static_cast<double>(nprop_sum) / conflict_count) << ", "
-        << (conflict_count == 0 ? 0.0 : static_cast<double>(nconflict_total) / conflict_count) << ", "
-        << (conflict_count == 0 ? 0.0 : static_cast<double>(nclauses_learned_sum) / conflict_count) << ", "
-        << (conflict_count == 0 ? 0.0 : static_cast<double>(nrestarts_sum) / conflict_count) << ", "
-        << (conflict_count == 0 || nclauses_learned_sum == 0 ? 0.0 : static_cast<double>(learned_length_sum) / nclauses_learned_sum) << ", "
-        // << bestObjVal << ","
-        << stats.getTime() << std::endl;
-
-              // << (opt == 1 ? "OPT" : (opt == 2 ? "UNSAT" : "UNK")) << ","
-        // << (conflict_count == 0 ? 0.0 : static_cast<double>(current_upper_bound_sum) / conflict_count)
-
-        
-        
+  // In the order of the v2 lines: LBD mean, trail pops per conflict, decisions and propagations per
+  // conflict, propagations per decision, moving averages of decisions and propagations per conflict, learned
+  // clauses and learned non-clausal constraints per conflict, restarts per conflict, and the mean learned
+  // constraint length.
+  std::array<double, nFeatures> features(const Mark& from, const Mark& to) const {
+    double nconflicts = to.conflicts - from.conflicts;
+    double ndecide = to.ndecide - from.ndecide;
+    double nprop = to.nprop - from.nprop;
+    double nclauses = to.nclauseslearned - from.nclauseslearned;
+    double nlearned = to.nlearned - from.nlearned;
+    return {ratio(to.lbdSum - from.lbdSum, to.lbdCount - from.lbdCount),
+            ratio(to.ntrailpops - from.ntrailpops, nconflicts),
+            ratio(ndecide, nconflicts),
+            ratio(nprop, nconflicts),
+            ratio(nprop, ndecide),
+            decideEma,
+            propEma,
+            ratio(nclauses, nconflicts),
+            ratio(nlearned - nclauses, nconflicts),
+            ratio(to.nrestarts - from.nrestarts, nconflicts),
+            ratio(to.learnedLengthSum - from.learnedLengthSum, nlearned)};
+  }
+
+  void checkpoint() {
+    Mark now = mark();
+    double time = stats.getTime();
+    std::cout << "c summary-v2 " << conflicts << " " << time;
+    for (double f : features(windowStart, now)) std::cout << " " << f;
+    std::cout << std::endl;
+    windowStart = now;
+    if (options.summaryConflicts.get() > 0) nextConflictMark = conflicts + options.summaryConflicts.get();
+    if (options.summaryTime.get() > 0) {
+      while (nextTimeMark <= time) nextTimeMark += options.summaryTime.get();
+    }
   }
 
+ public:
+  void init() {
+    nextConflictMark = options.summaryConflicts.get();
+    nextTimeMark = options.summaryTime.get();
+  }
+
+  // locked constraints keep a placeholder LBD, which only the legacy LBD mean includes
+  void addConflict(unsigned int lbd, bool locked) {
+    ++legacy.conflicts;
+    legacy.lbdSum += lbd == Constr::maxLBD ? legacyLockedLBD : lbd;
+    legacy.ndecide += stats.NDECIDE;
+    legacy.nprop += stats.NPROP;
+    legacy.nconfl += stats.NCONFL;
+    legacy.nclauseslearned += stats.NCLAUSESLEARNED;
+    legacy.ntrailpops += stats.NTRAILPOPS;
+    legacy.nrestarts += stats.NRESTARTS;
+    if (stats.NCLAUSESLEARNED > 0) legacy.learnedLengthSum += stats.LEARNEDLENGTHSUM;
+
+    if (!locked) {
+      lbdSum += lbd;
+      ++lbdCount;
+    }
+    ++conflicts;
+    double ndecide = stats.NDECIDE - lastDecide;
+    double nprop = stats.NPROP - lastProp;
+    lastDecide = stats.NDECIDE;
+    lastProp = stats.NPROP;
+    if (conflicts == 1) {
+      decideEma = ndecide;
+      propEma = nprop;
+    } else {
+      decideEma += emaWeight * (ndecide - decideEma);
+      propEma += emaWeight * (nprop - propEma);
+    }
+    if (conflicts == nextConflictMark ||
+        (nextTimeMark > 0 && (conflicts & 63) == 0 && stats.getTime() >= nextTimeMark))
+      checkpoint();
+  }
 
+  template <typename LARGE>
+  void printSummary(std::ostream& out, int opt, const LARGE& bestObjVal) const {
+    out << "c features-v2";
+    for (double f : features(Mark(), mark())) out << " " << f;
+    out << std::endl;
+
+    const Legacy& l = legacy;
+    double n = l.conflicts;
+    out << (opt == 1 ? "OPT" : (opt == 2 ? "UNSAT" : "UNK")) << "," << bestObjVal << "," << ratio(l.lbdSum, n) << ","
+        << ratio(l.ntrailpops, n) << "," << ratio(l.ndecide, l.nconfl) << "," << ratio(l.nprop, l.nconfl) << ","
+        << ratio(l.nprop, l.ndecide) << "," << ratio(l.ndecide, n) << ", " << ratio(l.nprop, n) << ", "
+        << ratio(l.nconfl, n) << ", " << ratio(l.nclauseslearned, n) << ", " << ratio(l.nrestarts, n) << ", "
+        << ratio(l.learnedLengthSum, l.nclauseslearned) << ", " << stats.getTime() << std::endl;
+  }
 };
 
 class Solver {
@@ -138,6 +225,7 @@ class Solver {
  private:
   SummaryStats summary_stats;
   int garbage_calls;
+  CeSuper (Solver::*analyzeWidth)(CeSuper);  // see analyzeAs
   int n;
   int orig_n;
   ID crefID = ID_Trivial;
@@ -145,14 +233,20 @@ class Solver {
   IntSet actSet;  // Set of literals that need their activity bumped after conflict analysis.
   OrderHeap order_heap;
   Graph graph;
+  // With --graph-incremental, the graph holds constraints[0..graphSynced) and the constraints with IDs graphRemoved.
+  size_t graphSynced = 0;
+  std::vector<ID> graphRemoved;
   std::unordered_map<ID, CRef> external;
+  std::unique_ptr<WorkerPool> gcPool;  // updates the watches in parallel during garbage collection
   std::vector<std::vector<Watch>> _adj = {{}};
   std::vector<std::vector<Watch>>::iterator adj;
   std::vector<int> _Level = {INF};
-  IntVecIt Level;  // TODO: make Pos, Level, contiguous memory for better cache efficiency.
+  Levels Level;
+  std::vector<VarState> states = {VarState()};  // viewed through Pos and Reason
+  Positions Pos;
+  Reasons Reason;
   std::vector<Lit> trail;
-  std::vector<int> trail_lim, Pos;
-  std::vector<CRef> Reason;
+  std::vector<int> trail_lim;
   int qhead = 0;  // for unit propagation
 
   std::vector<Lit> phase;
@@ -160,7 +254,6 @@ class Solver {
 
   long long nconfl_to_reduce = 2000;
   long long nconfl_to_restart = 0;
-  bool hasRestarted = false;
   ActValV v_vsids_inc = 1.0;
   ActValC c_vsids_inc = 1.0;
 
@@ -169,6 +262,11 @@ class Solver {
   std::shared_ptr<LpSolver> lpSolver;
   std::vector<std::unique_ptr<ConstrSimpleSuper>> learnedStack;
 
+  bool bulkLoading = false;
+  std::vector<std::unique_ptr<ConstrSimpleSuper>> bulkStack;  // formula constraints waiting for endBulkLoad
+  std::vector<int> bulkLitCount;  // occurrences of literal l in bulkStack, at index 2*|l| + (l < 0)
+  long long bulkMemSize = 0;
+
   IntSet assumptions;
 
  public:
@@ -177,9 +275,11 @@ class Solver {
 
   template <typename LARGE>
   void printSummaryStats(std::ostream& out, int opt, const LARGE& bestObjVal) const {
+    if (options.staticFeatures) stats.staticFeatures.print(out);
     summary_stats.printSummary(out, opt, bestObjVal);
   }
 
+  void benchmarkCentrality();  // prints the time each centrality heuristic takes on the current formula
   void init();  // call after having read options
   void initLP(const CeArb objective);
 
@@ -187,13 +287,17 @@ class Solver {
   void setNbVars(long long nvars, bool orig = false);
   int getNbOrigVars() const { return orig_n; }
 
-  const IntVecIt& getLevel() const { return Level; }
-  const std::vector<int>& getPos() const { return Pos; }
+  const Levels& getLevel() const { return Level; }
+  const Positions& getPos() const { return Pos; }
   int decisionLevel() const { return trail_lim.size(); }
 
   std::pair<ID, ID> addConstraint(const CeSuper c, Origin orig);             // result: formula line id, processed id
   std::pair<ID, ID> addConstraint(const ConstrSimpleSuper& c, Origin orig);  // result: formula line id, processed id
   std::pair<ID, ID> addUnitConstraint(Lit l, Origin orig);                   // result: formula line id, processed id
+  // Between these calls, formula constraints are only queued. endBulkLoad attaches all of them in one sweep, with
+  // the allocator and watch lists sized up front, and propagates once. Returns false if the formula is inconsistent.
+  void startBulkLoad();
+  bool endBulkLoad();
   void dropExternal(ID id, bool erasable, bool forceDelete);
   int getNbConstraints() const { return constraints.size(); }
   CeSuper getIthConstraint(int i) { return ca[constraints[i]].toExpanded(cePools); }
@@ -247,7 +351,6 @@ class Solver {
   // Conflict analysis
 
   void recomputeLBD(Constr& C);
-  CeSuper prepareConflictConstraint(CeSuper conflict);
   /**
    * @brief Get initial set of literals that need their activity bumped after conflict analysis.
    *
@@ -257,7 +360,23 @@ class Solver {
   Constr& getReasonConstraint(Lit l);
   void trackReasonConstraintStats(Constr& reasonC);
   void bumpLiteralActivity();
-  CeSuper analyze(CeSuper confl);
+  /**
+   * @brief Resolve the conflict on the trail until it is asserting, working on the concrete expression type.
+   *
+   * @param ce Conflict side constraint, typed so the per-literal calls are not virtual.
+   * @param confl The same constraint, used for reasons that only resolve through the generic interface.
+   */
+  template <typename SMALL, typename LARGE>
+  void resolveConflict(ConstrExp<SMALL, LARGE>& ce, CeSuper& confl);
+  /**
+   * @brief Analyze the conflict in a constraint expression of the given width.
+   *
+   * init() picks the instantiation matching options.bitsOverflow as analyzeWidth, so analyze() does not inspect the
+   * type of the conflict constraint.
+   */
+  template <typename SMALL, typename LARGE>
+  CeSuper analyzeAs(CeSuper conflict);
+  CeSuper analyze(CeSuper confl) { return (this->*analyzeWidth)(confl); }
   std::vector<CeSuper> extractCore(CeSuper confl, const IntSet& assumptions, Lit l_assump = 0);
 
   // ---------------------------------------------------------------------
@@ -267,6 +386,7 @@ class Solver {
   void learnConstraint(const CeSuper c, Origin orig);
   CeSuper processLearnedStack();
   std::pair<ID, ID> addInputConstraint(CeSuper ce);
+  std::pair<ID, ID> attachInputConstraint(CeSuper ce, ID input, bool propagate);
   void removeConstraint(Constr& C, bool override = false);
 
   // ---------------------------------------------------------------------
@@ -282,7 +402,6 @@ class Solver {
   bool checkSAT();
   void printWholeConstraints();
   void buildVariablePriority();
-  long double** buildGraph();
   Lit pickBranchLit(bool lastSolPhase);
 };
 
@@ -32,49 +32,95 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "SolverStructs.hpp"
 #include "Options.hpp"
 #include "globals.hpp"
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // __linux__
 
 namespace rs {
 
-void ConstraintAllocator::capacity(uint32_t min_cap) {
+#ifdef __linux__
+#if WITHCREF64
+const CRefOfs maxCapacity = CRefOfs(1) << 38;  // 1TB of address space
+#else
+const CRefOfs maxCapacity = std::numeric_limits<CRefOfs>::max();
+#endif  // WITHCREF64
+
+// Reserves the address space without committing memory, falls back to realloc if it can not be reserved.
+static uint32_t* reserve(CRefOfs& reserved) {
+  void* mem = mmap(nullptr, sizeof(uint32_t) * (size_t)maxCapacity, PROT_NONE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mem == MAP_FAILED) return nullptr;
+  reserved = maxCapacity;
+  return (uint32_t*)mem;
+}
+#endif  // __linux__
+
+void ConstraintAllocator::capacity(CRefOfs min_cap) {
   if (cap >= min_cap) return;
 
-  uint32_t prev_cap = cap;
+  CRefOfs prev_cap = cap;
   while (cap < min_cap) {
     // NOTE: Multiply by a factor (13/8) without causing overflow, then add 2 and make the
     // result even by clearing the least significant bit. The resulting sequence of capacities
     // is carefully chosen to hit a maximum capacity that is close to the '2^32-1' limit when
     // using 'uint32_t' as indices so that as much as possible of this space can be used.
-    uint32_t delta = ((cap >> 1) + (cap >> 3) + 2) & ~1;
+    CRefOfs delta = ((cap >> 1) + (cap >> 3) + 2) & ~CRefOfs(1);
     cap += delta;
     if (cap <= prev_cap) throw OutOfMemoryException();
   }
 
   assert(cap > 0);
+#ifdef __linux__
+  if (memory == nullptr) memory = reserve(reserved);
+  if (reserved > 0) {
+    if (min_cap > reserved) throw OutOfMemoryException();
+    cap = std::min(cap, reserved);
+    // commit the grown prefix in place, the kernel only backs the pages that get touched
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t bytes = (sizeof(uint32_t) * (size_t)cap + page - 1) / page * page;
+    if (mprotect(memory, bytes, PROT_READ | PROT_WRITE) != 0) throw OutOfMemoryException();
+    return;
+  }
+#endif  // __linux__
   memory = (uint32_t*)xrealloc(memory, sizeof(uint32_t) * cap);
 }
 
+void ConstraintAllocator::adviseHugePages() {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (reserved > 0) madvise(memory, sizeof(uint32_t) * (size_t)reserved, MADV_HUGEPAGE);
+#endif
+}
+
 // segment tree (fast implementation of priority queue).
+// Every inner node holds the variable of highest activity below it, the lower variable in case of a tie, so the
+// tree only depends on the variables in it and their activities.
 void OrderHeap::resize(int newsize) {
   if (cap >= newsize) return;
-  // insert elements in such order that tie breaking remains intact
-  std::vector<Var> variables;
-  while (!empty()) variables.push_back(removeMax());
-  tree.clear();
+  static_assert(resize_factor == 2, "the number of leaves must stay a power of two");
+  // the old tree becomes the leftmost subtree of the new one, with the same inner nodes
+  int oldcap = cap;
   while (cap < newsize) cap = cap * resize_factor + 1;
-  tree.resize(2 * (cap + 1), -1);
-  for (Var x : variables) insert(x);
+  int shift = (cap + 1) / (oldcap + 1);
+  std::vector<Var> grown(2 * (cap + 1), -1);
+  for (int level = 1; level <= oldcap + 1; level <<= 1) {
+    std::copy(tree.begin() + level, tree.begin() + 2 * level, grown.begin() + shift * level);
+  }
+  for (int at = shift / 2; at >= 1; at >>= 1) grown[at] = grown[shift];  // ancestors of the old root
+  tree.swap(grown);
 }
-void OrderHeap::recalculate() {  // TODO: more efficient implementation
-  // insert elements in such order that tie breaking remains intact
-  std::vector<Var> variables;
-  while (!empty()) variables.push_back(removeMax());
-  tree.clear();
-  tree.resize(2 * (cap + 1), -1);
-  for (Var x : variables) insert(x);
+void OrderHeap::recalculate() {
+  // recompute the inner nodes bottom-up, in linear time
+  for (int at = cap; at >= 1; --at) {
+    Var left = tree[2 * at];
+    Var right = tree[2 * at + 1];
+    tree[at] = (left == -1 || (right != -1 && activity[right] > activity[left])) ? right : left;
+  }
 }
 void OrderHeap::percolateUp(Var x) {
   for (int at = x + cap + 1; at > 1; at >>= 1) {
-    if (tree[at ^ 1] == -1 || activity[x] > activity[tree[at ^ 1]])
+    if (tree[at ^ 1] == -1 || activity[x] > activity[tree[at ^ 1]] ||
+        (!(at & 1) && activity[x] == activity[tree[at ^ 1]]))
       tree[at >> 1] = x;
     else
       break;
@@ -92,11 +138,10 @@ Var OrderHeap::removeMax() {
   Var x = tree[1];
   assert(x != -1);
   tree[x + cap + 1] = -1;
-  for (int at = x + cap + 1; at > 1; at >>= 1) {
-    if (tree[at ^ 1] != -1 && (tree[at] == -1 || activity[tree[at ^ 1]] > activity[tree[at]]))
-      tree[at >> 1] = tree[at ^ 1];
-    else
-      tree[at >> 1] = tree[at];
+  for (int at = (x + cap + 1) >> 1; at >= 1; at >>= 1) {
+    Var left = tree[2 * at];
+    Var right = tree[2 * at + 1];
+    tree[at] = (left == -1 || (right != -1 && activity[right] > activity[left])) ? right : left;
   }
   return x;
 }
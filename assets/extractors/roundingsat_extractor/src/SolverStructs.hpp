@@ -36,46 +36,100 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace rs {
 
+#if WITHCREF64
+using CRefOfs = uint64_t;
+#else
+using CRefOfs = uint32_t;
+#endif  // WITHCREF64
+
 struct CRef {
-  uint32_t ofs;
+  CRefOfs ofs;
   bool operator==(CRef const& o) const { return ofs == o.ofs; }
   bool operator!=(CRef const& o) const { return ofs != o.ofs; }
   bool operator<(CRef const& o) const { return ofs < o.ofs; }
   std::ostream& operator<<(std::ostream& os) { return os << ofs; }
 };
-const CRef CRef_Undef = {std::numeric_limits<uint32_t>::max()};
+const CRef CRef_Undef = {std::numeric_limits<CRefOfs>::max()};
+
+// Trail position and reason of a variable, which are set, and mostly read, together. The levels, which the watch
+// checks read on their own, stay in an array of their own, indexed by literal.
+struct VarState {
+  int pos = INF;             // position of v on the trail, INF if v is unassigned
+  CRef reason = CRef_Undef;  // CRef_Undef if v is decided or unassigned
+};
+
+// Views indexed like the separate arrays they replace. As with an iterator, a const view still gives write access.
+class Levels {  // decision level at which a literal became true, INF if it did not
+  int* levels = nullptr;
+
+ public:
+  Levels() = default;
+  explicit Levels(int* l) : levels(l) {}
+  int& operator[](Lit l) const { return levels[l]; }
+};
+class Positions {
+  VarState* states = nullptr;
+
+ public:
+  Positions() = default;
+  explicit Positions(VarState* s) : states(s) {}
+  int& operator[](Var v) const { return states[v].pos; }
+};
+class Reasons {
+  VarState* states = nullptr;
+
+ public:
+  Reasons() = default;
+  explicit Reasons(VarState* s) : states(s) {}
+  CRef& operator[](Var v) const { return states[v].reason; }
+};
 
 // TODO: make below methods part of a Solver object that's passed around
-inline bool isTrue(const IntVecIt& level, Lit l) { return level[l] != INF; }
-inline bool isFalse(const IntVecIt& level, Lit l) { return level[-l] != INF; }
-inline bool isUnit(const IntVecIt& level, Lit l) { return level[l] == 0; }
-inline bool isUnknown(const std::vector<int>& pos, Lit l) { return pos[toVar(l)] == INF; }
-inline bool isDecided(const std::vector<CRef>& reasons, Lit l) { return reasons[toVar(l)] == CRef_Undef; }
-inline bool isPropagated(const std::vector<CRef>& reasons, Lit l) { return !isDecided(reasons, l); }
+inline bool isTrue(const Levels& level, Lit l) { return level[l] != INF; }
+inline bool isFalse(const Levels& level, Lit l) { return level[-l] != INF; }
+inline bool isUnit(const Levels& level, Lit l) { return level[l] == 0; }
+inline bool isUnknown(const Positions& pos, Lit l) { return pos[toVar(l)] == INF; }
+inline bool isDecided(const Reasons& reasons, Lit l) { return reasons[toVar(l)] == CRef_Undef; }
+inline bool isPropagated(const Reasons& reasons, Lit l) { return !isDecided(reasons, l); }
 
 struct Watch {
   CRef cref;
   int idx;
   /**
+   * idx<BINARY+2^28: other literal of an implicit binary clause, stored as other-BINARY
    * idx<0: blocked literal for clausal propagation
    * 0<=idx<INF: index of watched literal for cardinality propagation
    * INF<=idx: index of watched literal for watched/counting propagation
    **/
+  // NOTE: blocked literals lie in ]-INF-2^28,-INF+2^28[ as there are less than maxVars variables
+  static const int maxVars = 1 << 28;
+  static const int BINARY = -1600000000;
+  static const int binaryBound = BINARY + maxVars;
+
   Watch(CRef cr, int i) : cref(cr), idx(i){};
+  static Watch binary(CRef cr, Lit other) { return Watch(cr, other + BINARY); }
+  bool isBinary() const { return idx < binaryBound; }
+  Lit binaryLit() const {
+    assert(isBinary());
+    return idx - BINARY;
+  }
   bool operator==(const Watch& other) const { return other.cref == cref && other.idx == idx; }
 };
 
 // ---------------------------------------------------------------------
-// Memory. Maximum supported size of learnt constraint database is 16GB
+// Memory. Maximum supported size of learnt constraint database is 16GB, or 1TB when compiled with 64-bit CRefs.
+// On Linux, the whole range is reserved up front and only the part in use is committed, so growing never copies.
 
 struct ConstraintAllocator {
-  uint32_t* memory = nullptr;  // TODO: why not uint64_t?
-  uint32_t at = 0, cap = 0;
-  uint32_t wasted = 0;  // for GC
-  void capacity(uint32_t min_cap);
+  uint32_t* memory = nullptr;
+  CRefOfs at = 0, cap = 0;
+  CRefOfs wasted = 0;    // for GC
+  CRefOfs reserved = 0;  // size of the reserved range, 0 if memory is realloc'ed instead
+  void capacity(CRefOfs min_cap);
+  void adviseHugePages();
   template <typename C>
   C* alloc(int nTerms) {
-    uint32_t oldAt = at;
+    CRefOfs oldAt = at;
     at += C::getMemSize(nTerms);
     capacity(at);
     return (C*)(memory + oldAt);
@@ -31,6 +31,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
+#include "Trace.hpp"
 #include "auxiliary.hpp"
 #include "typedefs.hpp"
 #include <fstream>
@@ -40,6 +41,47 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace rs {
 
+// The feature vector of the static extractor (assets/extractors/static_extractor),
+// collected line by line while the OPB file is read so the instance is parsed only once.
+struct StaticFeatures {
+  long long nvars = 0, ncons = 0;  // as announced by the "* #variable= #constraint=" header
+  long long r_u = 0, r_b = 0, r_t = 0, r_q = 0;
+  long long t_fo = 0, t_res = 0, t_pos_r = 0, t_pos_fo = 0;
+
+  void countLine(const char* b, const char* e) {
+    if (b == e || *b == '*') return;
+    if (e - b >= 3 && b[0] == 'm' && b[1] == 'i' && b[2] == 'n') {
+      for (const char* p = b + 3; p < e; ++p) {
+        if (*p == '+') ++t_fo, ++t_pos_fo;
+        else if (*p == '-') ++t_fo;
+      }
+      return;
+    }
+    long long t = 0, pos = 0;
+    for (const char* p = b; p < e; ++p) {
+      if (*p == '+') ++t, ++pos;
+      else if (*p == '-') ++t;
+      else if (*p == '>' || *p == '=' || *p == '<') break;
+    }
+    t_res += t;
+    t_pos_r += pos;
+    if (t == 1) ++r_u;
+    else if (t == 2) ++r_b;
+    else if (t == 3) ++r_t;
+    else if (t >= 4) ++r_q;
+  }
+
+  // Same values and formatting as the static extractor's output line.
+  void print(std::ostream& out) const {
+    int r = ncons, v = nvars;
+    double tot = t_fo + t_res;
+    out << "c static-features " << r << " " << v << " " << (r > 0 ? r_u / (double)r : 0) << " "
+        << (r > 0 ? r_b / (double)r : 0) << " " << (r > 0 ? r_t / (double)r : 0) << " "
+        << (r > 0 ? r_q / (double)r : 0) << " " << (tot > 0 ? t_fo / tot : 0) << " " << (tot > 0 ? t_res / tot : 0)
+        << " " << (t_res > 0 ? t_pos_r / (double)t_res : 0) << " " << (t_fo > 0 ? t_pos_fo / (double)t_fo : 0)
+        << std::endl;
+  }
+};
 
 struct Stats {
 
@@ -54,10 +96,9 @@ bool TLE(){
   bool isOpt = false;
   int timelimit;
   std::chrono::high_resolution_clock::time_point startTime; //std::chrono::high_resolution_clock::now();  
-  std::stringstream restartStream;
-  std::stringstream decisionStream;
+  Trace trace;
   std::stringstream timeStream;
-  std::stringstream fixedStream;
+  StaticFeatures staticFeatures;
   std::vector<int> solveCount;
   long long currentLowerBound = 0; // Mejor valor de la función objetivo encontrado
   long long currentUpperBound = 0; // Valor actual de la función objetivo
@@ -68,7 +109,7 @@ bool TLE(){
             NRESOLVESTEPS = 0, NMAXCONSTRAINTS = 0;
   long long NWATCHED = 0, NCOUNTING = 0;
   int128 EXTERNLENGTHSUM = 0, LEARNEDLENGTHSUM = 0;
-  bigint EXTERNDEGREESUM = 0, LEARNEDDEGREESUM = 0;
+  double EXTERNDEGREESUM = 0, LEARNEDDEGREESUM = 0;
   long long NCLAUSESEXTERN = 0, NCARDINALITIESEXTERN = 0, NGENERALSEXTERN = 0;
   long long NCLAUSESLEARNED = 0, NCARDINALITIESLEARNED = 0, NGENERALSLEARNED = 0;
   long long NGCD = 0, NCARDDETECT = 0, NCORECARDINALITIES = 0, NCORES = 0, NSOLS = 0;
@@ -96,6 +137,8 @@ bool TLE(){
   double HEURISTICAMOUNT = 0;
   double SOLVETIME = 0, SOLVETIMECG = 0, CATIME = 0, PROPTIME = 0;
   double RUNSTARTTIME = 0;
+  double PARSETIME = 0;
+  long long PARSEBYTES = 0;
 
   inline double getTime() const { return aux::cpuTime() - STARTTIME; }
   inline double getRunTime() const { return aux::cpuTime() - RUNSTARTTIME; }
@@ -127,45 +170,6 @@ bool TLE(){
     std::cout << std::endl;
   }
 
-  void printRestart(std::string formulaName){
-    std::ofstream restartFile("amanda_results/" + formulaName + "_" + "restart.txt");
-    // std::ofstream decisionFile("lukas_results/" + formulaName + "_" + "decision.txt");
-    // std::ofstream timeFile("cata_results/" + formulaName + "_" + "times.txt");
-    // std::ofstream fixedFile("irri_results/" + formulaName + "_" + "fixed.txt");
-    if(!solveCount.empty()){
-        for( Var v=1; v<=NORIGVARS; ++v){
-            fixedStream << -v <<' '<<solveCount[v<<1] << '\n';
-
-            fixedStream << v <<' '<< solveCount[(v<<1)+1] << '\n';
-	    
-
-        }
-    }
-
-    if (!restartFile) {
-        std::cerr << "Cannot open the output file!" << std::endl;
-        exit(1);
-    }
-
-    if (restartFile){
-      restartFile << restartStream.str();
-
-      if (restartFile.fail()) {
-        std::cerr << "Failed to write to the file." << std::endl;
-        exit(1);
-      }
-  
-      restartFile.close();
-      if (restartFile.fail()) {
-        std::cerr << "Failed to close the file." << std::endl;
-        exit(1);
-      }
-    }
-    else {
-      std::cout<< "Error\n" << std::endl;
-    }
-  }
-
   void printFile(std::string formulaName, int isSat, bigint bestObjVal) const {
     std::unordered_map<std::string, std::string> data;
     std::ofstream resultsFile;  
@@ -281,8 +285,15 @@ bool TLE(){
     }
   }
 
+  void printParse() const {
+    printf("c parse time %g s\n", PARSETIME);
+    printf("c parse size %lld bytes\n", PARSEBYTES);
+    printf("c parse throughput %g MB/s\n", PARSETIME > 0 ? PARSEBYTES / PARSETIME / (1 << 20) : 0);
+  }
+
   void print() const {
     printf("c cpu time %g s\n", getTime());
+    printParse();
     printf("c deterministic time %lld %.2e\n", getDetTime(), (double)getDetTime());
     printf("c optimization time %g s\n", getRunTime() - getSolveTime());
     printf("c total solve time %g s\n", getSolveTime());
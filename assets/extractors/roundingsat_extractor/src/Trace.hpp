@@ -0,0 +1,111 @@
+/***********************************************************************
+Copyright (c) 2014-2020, Jan Elffers
+Copyright (c) 2019-2021, Jo Devriendt
+Copyright (c) 2020-2021, Stephan Gocht
+Copyright (c) 2014-2021, Jakob Nordström
+
+Parts of the code were copied or adapted from MiniSat.
+
+MiniSat -- Copyright (c) 2003-2006, Niklas Een, Niklas Sorensson
+           Copyright (c) 2007-2010  Niklas Sorensson
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace rs {
+
+// Binary trace of search events, kept in a fixed-capacity ring so that only the most recent events survive.
+// Recording is compiled in only when building with -Dtrace=ON (WITHTRACE), and then only active when a capacity
+// is given through enable(), so production runs pay nothing for it.
+struct Trace {
+  enum Event : uint32_t { VARS = 0, DECISION = 1, RESTART = 2, SOLUTION = 3 };
+
+  struct Record {
+    uint32_t event;
+    int32_t value;       // number of variables, decision literal, restart count or zero
+    uint64_t conflicts;  // number of conflicts when the event happened
+  };
+  static_assert(sizeof(Record) == 16);
+
+  static constexpr char magic[8] = {'R', 'S', 'T', 'R', 'A', 'C', 'E', '\x01'};
+
+ private:
+  std::vector<Record> ring;
+  uint64_t mask = 0;
+  uint64_t total = 0;
+
+ public:
+  static constexpr bool compiled() {
+#if WITHTRACE
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  // rounds the capacity up to a power of two
+  void enable([[maybe_unused]] uint64_t capacity) {
+#if WITHTRACE
+    uint64_t cap = 1;
+    while (cap < capacity) cap <<= 1;
+    ring.assign(cap, {0, 0, 0});
+    mask = cap - 1;
+    total = 0;
+#endif
+  }
+
+  void record([[maybe_unused]] Event e, [[maybe_unused]] int32_t value, [[maybe_unused]] uint64_t conflicts) {
+#if WITHTRACE
+    if (ring.empty()) return;
+    ring[total & mask] = {e, value, conflicts};
+    ++total;
+#endif
+  }
+
+  // File layout: magic, uint64 number of recorded events, uint64 number of stored records, then the stored records
+  // from oldest to newest.
+  bool dump(const std::string& path) const {
+    if (ring.empty()) return true;
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    uint64_t stored = std::min<uint64_t>(total, ring.size());
+    out.write(magic, sizeof(magic));
+    out.write(reinterpret_cast<const char*>(&total), sizeof(total));
+    out.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+    uint64_t first = total - stored;
+    uint64_t head = first & mask;
+    uint64_t tail = std::min<uint64_t>(stored, ring.size() - head);
+    out.write(reinterpret_cast<const char*>(ring.data() + head), tail * sizeof(Record));
+    out.write(reinterpret_cast<const char*>(ring.data()), (stored - tail) * sizeof(Record));
+    return static_cast<bool>(out);
+  }
+};
+
+}  // namespace rs
@@ -0,0 +1,100 @@
+/***********************************************************************
+Copyright (c) 2014-2020, Jan Elffers
+Copyright (c) 2019-2021, Jo Devriendt
+Copyright (c) 2020-2021, Stephan Gocht
+Copyright (c) 2014-2021, Jakob Nordström
+
+Parts of the code were copied or adapted from MiniSat.
+
+MiniSat -- Copyright (c) 2003-2006, Niklas Een, Niklas Sorensson
+           Copyright (c) 2007-2010  Niklas Sorensson
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rs {
+
+// A fixed set of threads that repeatedly run one job split into parts. run(job) calls job(p) for every part p, part 0
+// on the calling thread and every other part on its own worker, and returns once all parts are done. The workers wait
+// between jobs, so the threads are started once for many short jobs.
+class WorkerPool {
+  std::vector<std::thread> workers;
+  std::mutex mtx;
+  std::condition_variable start, done;
+  const std::function<void(int)>* job = nullptr;
+  unsigned long long generation = 0;
+  int running = 0;
+  bool stopping = false;
+
+  void work(int part) {
+    unsigned long long seen = 0;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+      start.wait(lock, [&] { return stopping || generation != seen; });
+      if (stopping) return;
+      seen = generation;
+      lock.unlock();
+      (*job)(part);
+      lock.lock();
+      if (--running == 0) done.notify_one();
+    }
+  }
+
+ public:
+  explicit WorkerPool(int parts) {
+    for (int p = 1; p < parts; ++p) workers.emplace_back(&WorkerPool::work, this, p);
+  }
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
+    }
+    start.notify_all();
+    for (std::thread& t : workers) t.join();
+  }
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  int size() const { return workers.size() + 1; }
+
+  void run(const std::function<void(int)>& f) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      job = &f;
+      running = workers.size();
+      ++generation;
+    }
+    start.notify_all();
+    f(0);
+    std::unique_lock<std::mutex> lock(mtx);
+    done.wait(lock, [&] { return running == 0; });
+  }
+};
+
+}  // namespace rs
@@ -246,6 +246,25 @@ unsigned msb(const T& x) {
   return boost::multiprecision::msb(boost::multiprecision::uint128_t(x));
 }
 template <>
+inline unsigned msb(const int& x) {
+  assert(x > 0);
+  return 31 - __builtin_clz(x);
+}
+template <>
+inline unsigned msb(const long long& x) {
+  assert(x > 0);
+  return 63 - __builtin_clzll(x);
+}
+#if !WITHGMP
+template <>
+inline unsigned msb(const int128& x) {
+  assert(x > 0);
+  unsigned long long high = static_cast<unsigned long long>(x >> 64);
+  if (high != 0) return 127 - __builtin_clzll(high);
+  return 63 - __builtin_clzll(static_cast<unsigned long long>(x));
+}
+#endif  // !WITHGMP
+template <>
 inline unsigned msb(const bigint& x) {
   assert(x > 0);
   return boost::multiprecision::msb(x);
@@ -332,10 +351,6 @@ inline int128 gcd(const int128& x, const int128& y) {
       boost::multiprecision::gcd(boost::multiprecision::int128_t(x), boost::multiprecision::int128_t(y)));
 }
 template <>
-inline unsigned msb(const int128& x) {
-  return boost::multiprecision::msb(boost::multiprecision::uint128_t(x));
-}
-template <>
 inline int128 pow(const int128& x, unsigned y) {
   return static_cast<int128>(boost::multiprecision::pow(boost::multiprecision::int128_t(x), y));
 }
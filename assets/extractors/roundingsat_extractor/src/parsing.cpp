@@ -30,8 +30,16 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************/
 
 #include "parsing.hpp"
+#include <sys/stat.h>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <sstream>
+#include <string_view>
+#include "LineReader.hpp"
 #include "Solver.hpp"
+#include "globals.hpp"
 
 namespace rs {
 
@@ -48,73 +56,272 @@ bigint parsing::read_number(const std::string& s) {
   return negate ? -answer : answer;
 }
 
-void parsing::opb_read(std::istream& in, Solver& solver, CeArb objective) {
+namespace {
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == ';'; }
+
+inline const char* skipBlanks(const char* p, const char* end) {
+  while (p < end && isBlank(*p)) ++p;
+  return p;
+}
+
+inline bool isRelation(char c) { return c == '>' || c == '<' || c == '='; }
+
+inline const char* tokenEnd(const char* p, const char* end) {
+  while (p < end && !isBlank(*p) && !isRelation(*p)) ++p;
+  return p;
+}
+
+// Parses an integer token such as "+12" or "-3" into a long long, and only builds a bigint when it overflows.
+BigCoef readCoef(const char* b, const char* e) {
+  const char* p = b;
+  bool negate = p < e && *p == '-';
+  if (p < e && (*p == '+' || *p == '-')) ++p;
+  long long val = 0;
+  for (; p < e; ++p) {
+    if (*p < '0' || *p > '9' || __builtin_mul_overflow(val, 10, &val) || __builtin_add_overflow(val, *p - '0', &val))
+      return parsing::read_number(std::string(b, e));
+  }
+  return negate ? -val : val;
+}
+
+// Parses "x12" or "~x12".
+Lit readLit(const char* b, const char* e) {
+  const char* p = b;
+  bool negated = p < e && *p == '~';
+  if (negated) ++p;
+  if (p == e || *p != 'x') quit::exit_ERROR({"Invalid literal token: ", std::string(b, e)});
+  long long v = 0;
+  for (++p; p < e && '0' <= *p && *p <= '9' && v < INF; ++p) v = 10 * v + (*p - '0');
+  if (p != e || v >= INF) quit::exit_ERROR({"Invalid literal token: ", std::string(b, e)});
+  if (v < 1) quit::exit_ERROR({"Variable token less than 1: ", std::string(b, e)});
+  return negated ? -v : v;
+}
+
+// ---------------------------------------------------------------------
+// Binary formula cache
+//
+// Layout, in native byte order:
+//   char[8]  magic ("RSCACHE" and a version byte)
+//   uint64   key of the source instance (see instanceKey)
+//   int64    variable count, original variable count, row count, term count
+//   int64[10] static feature counters (see StaticFeatures), counted even without --static-features
+//   int64[rows+1] offset of the first term of each row, row 0 being the objective
+//   int64[rows]   right-hand sides
+//   int64[terms]  coefficients
+//   int32[terms]  literals
+// Every row but the objective is a ">=" constraint over the variables, as ConstrExp::toSimple produces it.
+
+constexpr std::string_view cacheMagic("RSCACHE\x03", 8);
+constexpr size_t cacheHeaderWords = 1 + 1 + 4 + 10;
+
+struct FormulaCache {
+  std::vector<long long> rowStart = {0, 0};  // the objective is added last, but stored first
+  std::vector<long long> rhs = {0};
+  std::vector<long long> coefs;
+  std::vector<int> lits;
+  bool fits = true;
+
+  void add(const CeSuper& c, std::vector<long long>& cfs, std::vector<int>& ls, long long& r) {
+    ConstrSimpleArb simple;
+    c->toSimple()->copyTo(simple);
+    for (const Term<bigint>& t : simple.terms) {
+      fits = fits && aux::fits<long long>(t.c);
+      cfs.push_back(fits ? static_cast<long long>(t.c) : 0);
+      ls.push_back(t.l);
+    }
+    fits = fits && aux::fits<long long>(simple.rhs);
+    r = fits ? static_cast<long long>(simple.rhs) : 0;
+  }
+
+  void addConstraint(const CeSuper& c) {
+    rhs.emplace_back();
+    add(c, coefs, lits, rhs.back());
+    rowStart.push_back(coefs.size());
+  }
+
+  void write(const std::string& path, uint64_t hash, const Solver& solver, const CeArb& objective) {
+    if (!fits) {
+      std::cout << "c Not writing " << path << ": coefficients exceed 64 bits" << std::endl;
+      return;
+    }
+    std::vector<long long> objCoefs;
+    std::vector<int> objLits;
+    add(objective, objCoefs, objLits, rhs[0]);
+    if (!fits) {
+      std::cout << "c Not writing " << path << ": objective coefficients exceed 64 bits" << std::endl;
+      return;
+    }
+    for (long long& start : rowStart) start += objCoefs.size();
+    rowStart[0] = 0;
+    coefs.insert(coefs.begin(), objCoefs.begin(), objCoefs.end());
+    lits.insert(lits.begin(), objLits.begin(), objLits.end());
+
+    const StaticFeatures& sf = stats.staticFeatures;
+    long long header[cacheHeaderWords] = {0,
+                                          (long long)hash,
+                                          solver.getNbVars(),
+                                          solver.getNbOrigVars(),
+                                          (long long)rhs.size(),
+                                          (long long)coefs.size(),
+                                          sf.nvars, sf.ncons, sf.r_u, sf.r_b, sf.r_t, sf.r_q,
+                                          sf.t_fo, sf.t_res, sf.t_pos_r, sf.t_pos_fo};
+    std::memcpy(header, cacheMagic.data(), cacheMagic.size());
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(rowStart.data()), rowStart.size() * sizeof(long long));
+    out.write(reinterpret_cast<const char*>(rhs.data()), rhs.size() * sizeof(long long));
+    out.write(reinterpret_cast<const char*>(coefs.data()), coefs.size() * sizeof(long long));
+    out.write(reinterpret_cast<const char*>(lits.data()), lits.size() * sizeof(int));
+    if (!out) quit::exit_ERROR({"Could not write cache file ", path});
+  }
+};
+
+FormulaCache* recording = nullptr;  // set while a cache file is being recorded
+
+// FNV-1a over 64-bit words, then over the remaining bytes, finished with the length.
+uint64_t hashBytes(std::string_view s) {
+  const uint64_t prime = 1099511628211ULL;
+  uint64_t h = 14695981039346656037ULL;
+  size_t i = 0;
+  for (; i + 8 <= s.size(); i += 8) {
+    uint64_t w;
+    std::memcpy(&w, s.data() + i, 8);
+    h = (h ^ w) * prime;
+  }
+  for (; i < s.size(); ++i) h = (h ^ static_cast<unsigned char>(s[i])) * prime;
+  return (h ^ s.size()) * prime;
+}
+
+// Hash of the absolute path, size and modification time of a regular instance file, so that a cache can be checked
+// without reading the instance. Returns 0, i.e., no caching, for standard input and other streams.
+uint64_t instanceKey(const std::string& path) {
+  struct stat st;
+  if (path.empty() || stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+  char real[PATH_MAX];
+  if (realpath(path.c_str(), real) == nullptr) return 0;
+#ifdef __APPLE__
+  long long mtime = st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+  long long mtime = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+  long long size = st.st_size;
+  std::string key(real);
+  key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  key.append(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+  return hashBytes(key);
+}
+
+uint64_t cacheHash(std::string_view cache) {
+  if (cache.size() < cacheHeaderWords * sizeof(long long) || cache.substr(0, cacheMagic.size()) != cacheMagic)
+    return 0;
+  uint64_t hash;
+  std::memcpy(&hash, cache.data() + 8, sizeof(hash));
+  return hash;
+}
+
+void addFormulaConstraint(Solver& solver, const CeSuper& input) {
+  if (recording) recording->addConstraint(input);
+  if (solver.addConstraint(input, Origin::FORMULA).second == ID_Unsat) quit::exit_UNSAT(solver);
+}
+
+}  // namespace
+
+void parsing::cache_read(std::string_view cache, Solver& solver, CeArb objective) {
+  if (cache.size() < cacheHeaderWords * sizeof(long long) || cache.substr(0, cacheMagic.size()) != cacheMagic)
+    quit::exit_ERROR({"Invalid cache file."});
+  const char* p = cache.data() + 16;
+  auto next = [&](size_t words, size_t wordSize) {
+    const char* at = p;
+    if (words > size_t(cache.data() + cache.size() - p) / wordSize) quit::exit_ERROR({"Truncated cache file."});
+    p += words * wordSize;
+    return at;
+  };
+  const long long* header = reinterpret_cast<const long long*>(next(cacheHeaderWords - 2, sizeof(long long)));
+  long long nvars = header[0], norigvars = header[1], nrows = header[2], nterms = header[3];
+  // the sizes and terms come from disk, so check them before they index anything
+  auto corrupt = [] { quit::exit_ERROR({"Corrupt cache file."}); };
+  if (nvars < 0 || nvars >= INF || norigvars < 0 || norigvars > nvars || nrows < 1 || nterms < 0) corrupt();
+  StaticFeatures& sf = stats.staticFeatures;
+  sf.nvars = header[4], sf.ncons = header[5], sf.r_u = header[6], sf.r_b = header[7], sf.r_t = header[8];
+  sf.r_q = header[9], sf.t_fo = header[10], sf.t_res = header[11], sf.t_pos_r = header[12], sf.t_pos_fo = header[13];
+  const long long* rowStart = reinterpret_cast<const long long*>(next(nrows + 1, sizeof(long long)));
+  const long long* rhs = reinterpret_cast<const long long*>(next(nrows, sizeof(long long)));
+  const long long* coefs = reinterpret_cast<const long long*>(next(nterms, sizeof(long long)));
+  const int* lits = reinterpret_cast<const int*>(next(nterms, sizeof(int)));
+  if (rowStart[0] != 0 || rowStart[nrows] != nterms) corrupt();
+  for (long long r = 0; r < nrows; ++r) {
+    if (rowStart[r] > rowStart[r + 1] || rhs[r] == LLONG_MIN) corrupt();
+  }
+  for (long long i = 0; i < nterms; ++i) {
+    if (lits[i] == 0 || lits[i] < -nvars || lits[i] > nvars || coefs[i] == LLONG_MIN) corrupt();
+  }
+
+  if (norigvars > 0) solver.setNbVars(norigvars, true);
+  if (nvars > 0) solver.setNbVars(nvars);
+  for (long long i = rowStart[0]; i < rowStart[1]; ++i) objective->addLhs(coefs[i], lits[i]);
+  objective->addRhs(rhs[0]);
+  solver.startBulkLoad();
+  ConstrSimple64 row;
+  for (long long r = 1; r < nrows; ++r) {
+    row.terms.clear();
+    for (long long i = rowStart[r]; i < rowStart[r + 1]; ++i) row.terms.emplace_back(coefs[i], lits[i]);
+    row.rhs = rhs[r];
+    if (solver.addConstraint(row, Origin::FORMULA).second == ID_Unsat) quit::exit_UNSAT(solver);
+  }
+  if (!solver.endBulkLoad()) quit::exit_UNSAT(solver);
+}
+
+void parsing::opb_read(LineReader& in, Solver& solver, CeArb objective) {
   assert(objective->isReset());
   CeArb input = solver.cePools.takeArb();
   [[maybe_unused]] bool first_constraint = true;
-  for (std::string line; getline(in, line);) {
-    if (line.empty() || line[0] == '*') continue;
-    for (char& c : line)
-      if (c == ';') c = ' ';
-    bool opt_line = line.substr(0, 4) == "min:";
-    std::string line0;
-    if (opt_line)
-      line = line.substr(4), assert(first_constraint);
-    else {
-      std::string symbol;
-      if (line.find(">=") != std::string::npos)
-        symbol = ">=";
-      else
-        symbol = "=";
-      assert(line.find(symbol) != std::string::npos);
-      line0 = line;
-      line = line.substr(0, line.find(symbol));
-    }
+  for (const char *b, *e; in.nextLine(b, e);) {
+    if (skipBlanks(b, e) == e || *b == '*') continue;  // blank lines and comments
+    if (options.staticFeatures || recording) stats.staticFeatures.countLine(b, e);  // a cache always stores them
+    bool opt_line = e - b >= 4 && std::equal(b, b + 4, "min:");
+    if (opt_line) b += 4, assert(first_constraint);
     first_constraint = false;
-    std::istringstream is(line);
     input->reset();
-    std::vector<std::string> tokens;
-    std::string tmp;
-    while (is >> tmp) tokens.push_back(tmp);
-    if (tokens.size() % 2 != 0) quit::exit_ERROR({"No support for non-linear constraints."});
-    for (int i = 0; i < (long long)tokens.size(); i += 2)
-      if (find(tokens[i].begin(), tokens[i].end(), 'x') != tokens[i].end())
-        quit::exit_ERROR({"No support for non-linear constraints."});
-    for (int i = 0; i < (long long)tokens.size(); i += 2) {
-      std::string scoef = tokens[i];
-      std::string var = tokens[i + 1];
-      BigCoef coef = read_number(scoef);
-      bool negated = false;
-      std::string origvar = var;
-      if (!var.empty() && var[0] == '~') {
-        negated = true;
-        var = var.substr(1);
-      }
-      if (var.empty() || var[0] != 'x') quit::exit_ERROR({"Invalid literal token: ", origvar});
-      var = var.substr(1);
-      Lit l = atoi(var.c_str());
-      if (l < 1) quit::exit_ERROR({"Variable token less than 1: ", origvar});
-      if (negated) l = -l;
+    // terms, until the relational operator
+    const char* p = skipBlanks(b, e);
+    while (p < e && !isRelation(*p)) {
+      const char* q = tokenEnd(p, e);
+      if (std::find(p, q, 'x') != q) quit::exit_ERROR({"No support for non-linear constraints."});
+      BigCoef coef = readCoef(p, q);
+      p = skipBlanks(q, e);
+      if (p == e) quit::exit_ERROR({"No support for non-linear constraints."});
+      q = tokenEnd(p, e);
+      Lit l = readLit(p, q);
       solver.setNbVars(std::abs(l), true);
       input->addLhs(coef, l);
+      p = skipBlanks(q, e);
     }
-    if (opt_line)
+    if (opt_line) {
       input->copyTo(objective);
-    else {
-      input->addRhs(read_number(line0.substr(line0.find("=") + 1)));
-      if (solver.addConstraint(input, Origin::FORMULA).second == ID_Unsat) quit::exit_UNSAT(solver);
-      if (line0.find(" = ") != std::string::npos) {  // Handle equality case with second constraint
-        input->invert();
-        if (solver.addConstraint(input, Origin::FORMULA).second == ID_Unsat) quit::exit_UNSAT(solver);
-      }
+      continue;
+    }
+    const char* q = p;
+    while (q < e && isRelation(*q)) ++q;
+    std::string_view symbol(p, q - p);
+    if (symbol != ">=" && symbol != "=" && symbol != "<=")
+      quit::exit_ERROR({"Invalid relational operator: ", std::string(b, e)});
+    p = skipBlanks(q, e);
+    input->addRhs(readCoef(p, tokenEnd(p, e)));
+    if (symbol == "<=") input->invert();
+    addFormulaConstraint(solver, input);
+    if (symbol == "=") {  // Handle equality case with second constraint
+      input->invert();
+      addFormulaConstraint(solver, input);
     }
   }
 }
 
-void parsing::wcnf_read(std::istream& in, BigCoef top, Solver& solver, CeArb objective) {
+void parsing::wcnf_read(LineReader& in, BigCoef top, Solver& solver, CeArb objective) {
   assert(objective->isReset());
   CeArb input = solver.cePools.takeArb();
-  for (std::string line; getline(in, line);) {
+  for (const char *b, *e; in.nextLine(b, e);) {
+    std::string line(b, e);
     if (line.empty() || line[0] == 'c')
       continue;
     else {
@@ -135,14 +342,15 @@ void parsing::wcnf_read(std::istream& in, BigCoef top, Solver& solver, CeArb obj
         objective->addLhs(weight, solver.getNbVars());
         input->addLhs(1, solver.getNbVars());
       }  // else hard clause
-      if (solver.addConstraint(input, Origin::FORMULA).second == ID_Unsat) quit::exit_UNSAT(solver);
+      addFormulaConstraint(solver, input);
     }
   }
 }
 
-void parsing::cnf_read(std::istream& in, Solver& solver) {
+void parsing::cnf_read(LineReader& in, Solver& solver) {
   Ce32 input = solver.cePools.take32();
-  for (std::string line; getline(in, line);) {
+  for (const char *b, *e; in.nextLine(b, e);) {
+    std::string line(b, e);
     if (line.empty() || line[0] == 'c')
       continue;
     else {
@@ -154,13 +362,40 @@ void parsing::cnf_read(std::istream& in, Solver& solver) {
         solver.setNbVars(std::abs(l), true);
         input->addLhs(1, l);
       }
-      if (solver.addConstraint(input, Origin::FORMULA).second == ID_Unsat) quit::exit_UNSAT(solver);
+      addFormulaConstraint(solver, input);
     }
   }
 }
 
-void parsing::file_read(std::istream& in, Solver& solver, CeArb objective) {
-  for (std::string line; getline(in, line);) {
+size_t parsing::file_read(LineReader& in, Solver& solver, CeArb objective) {
+  if (in.startsWith(cacheMagic)) {
+    std::string_view cache = in.remaining();
+    cache_read(cache, solver, objective);
+    return cache.size();
+  }
+  const std::string& cachePath = options.cacheFile.get();
+  FormulaCache cache;
+  uint64_t hash = 0;
+  if (!cachePath.empty()) {
+    hash = instanceKey(options.formulaName);
+    if (hash == 0) {
+      if (options.verbosity.get() > 0) std::cout << "c Not caching an input that is not a regular file" << std::endl;
+    } else {
+      if (std::ifstream(cachePath).good()) {
+        LineReader cached(cachePath);
+        if (cacheHash(cached.remaining()) == hash) {
+          if (options.verbosity.get() > 0) std::cout << "c Reading cached formula " << cachePath << std::endl;
+          std::string_view cachedFormula = cached.remaining();
+          cache_read(cachedFormula, solver, objective);
+          return cachedFormula.size();
+        }
+      }
+      recording = &cache;
+    }
+  }
+  solver.startBulkLoad();
+  for (const char *b, *e; in.nextLine(b, e);) {
+    std::string line(b, e);
     if (line.empty() || line[0] == 'c') continue;
     if (line[0] == 'p') {
       std::istringstream is(line);
@@ -180,11 +415,20 @@ void parsing::file_read(std::istream& in, Solver& solver, CeArb objective) {
         wcnf_read(in, top, solver, objective);
       }
     } else if (line[0] == '*' && line.substr(0, 13) == "* #variable= ") {
+      std::istringstream is(line.substr(13));
+      std::string skip;
+      is >> stats.staticFeatures.nvars >> skip >> stats.staticFeatures.ncons;
       opb_read(in, solver, objective);
     } else {
       quit::exit_ERROR({"No supported format [opb, cnf, wcnf] detected."});
     }
   }
+  if (recording) {
+    recording = nullptr;
+    cache.write(cachePath, hash, solver, objective);
+  }
+  if (!solver.endBulkLoad()) quit::exit_UNSAT(solver);
+  return in.bytesRead();
 }
 
 }  // namespace rs
@@ -32,19 +32,22 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include <string>
+#include <string_view>
 #include "typedefs.hpp"
 
 namespace rs {
 
 class Solver;
+class LineReader;
 
 namespace parsing {
 
 bigint read_number(const std::string& s);
-void opb_read(std::istream& in, Solver& solver, CeArb objective);
-void wcnf_read(std::istream& in, BigCoef top, Solver& solver, CeArb objective);
-void cnf_read(std::istream& in, Solver& solver);
-void file_read(std::istream& in, Solver& solver, CeArb objective);
+void opb_read(LineReader& in, Solver& solver, CeArb objective);
+void wcnf_read(LineReader& in, BigCoef top, Solver& solver, CeArb objective);
+void cnf_read(LineReader& in, Solver& solver);
+void cache_read(std::string_view cache, Solver& solver, CeArb objective);
+size_t file_read(LineReader& in, Solver& solver, CeArb objective);  // returns the number of bytes parsed
 
 }  // namespace parsing
 
@@ -37,6 +37,11 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace rs {
 
+static void dumpTrace() {
+  const std::string& path = options.traceFile.get();
+  if (!path.empty() && !stats.trace.dump(path)) std::cerr << "c Could not write trace file " << path << std::endl;
+}
+
 void quit::printSol(const std::vector<Lit>& sol) {
   printf("v");
   for (Var v = 1; v < (Var)sol.size() - stats.NAUXVARS; ++v) printf(sol[v] > 0 ? " x%d" : " -x%d", v);
@@ -64,7 +69,7 @@ void quit::exit_SAT(const Solver& solver) {
   std::filesystem::path filePath(options.formulaName);
   solver.printSummaryStats(std::cout, -1, 1);
   // stats.printStatus(filePath.filename(), 1, 1);
-  // stats.printRestart(filePath.filename());
+  dumpTrace();
   if (options.printSol) printSol(solver.lastSol);
   exit(0);
 }
@@ -82,12 +87,12 @@ void quit::exit_UNSAT(const Solver& solver, const LARGE& bestObjVal) {
     if (options.printSol) printSol(solver.lastSol);
     // stats.printStatus(filePath.filename(), 2, bestObjVal);
     solver.printSummaryStats(std::cout, 1, bestObjVal);
-    // stats.printRestart(filePath.filename());
+    dumpTrace();
     exit(0);
   } else {
     // stats.printStatus(filePath.filename(), 0, -1);
     solver.printSummaryStats(std::cout, 2, -1);
-    // stats.printRestart(filePath.filename());
+    dumpTrace();
     exit(0);
   }
 }
@@ -108,7 +113,7 @@ void quit::exit_INDETERMINATE(const Solver& solver) {
   }
   // stats.printStatus(filePath.filename(), -1, -1);
   solver.printSummaryStats(std::cout, -1, -1);
-  // stats.printRestart(filePath.filename());
+  dumpTrace();
   exit(0);
 }
 
@@ -30,8 +30,8 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************/
 
 #include <csignal>
-#include <fstream>
 #include <memory>
+#include "LineReader.hpp"
 #include "auxiliary.hpp"
 #include "globals.hpp"
 #include "parsing.hpp"
@@ -64,6 +64,12 @@ int main(int argc, char** argv) {
 
   rs::stats.timelimit = rs::options.timeout.get();
 
+  if (!rs::options.traceFile.get().empty()) {
+    if (!rs::Trace::compiled())
+      rs::quit::exit_ERROR({"Tracing is not compiled in, configure the build with -Dtrace=ON to use --trace-file."});
+    rs::stats.trace.enable(rs::options.traceSize.get());
+  }
+
   if (rs::options.verbosity.get() > 0) {
     std::cout << "c RoundingSat 2\n";
     std::cout << "c branch " << EXPANDED(GIT_BRANCH) << "\n";
@@ -74,13 +80,22 @@ int main(int argc, char** argv) {
   rs::run::solver.init();
   rs::CeArb objective = rs::run::solver.cePools.takeArb();
 
-  if (!rs::options.formulaName.empty()) {
-    std::ifstream fin(rs::options.formulaName);
-    if (!fin) rs::quit::exit_ERROR({"Could not open ", rs::options.formulaName});
-    rs::parsing::file_read(fin, rs::run::solver, objective);
-  } else {
-    if (rs::options.verbosity.get() > 0) std::cout << "c No filename given, reading from standard input" << std::endl;
-    rs::parsing::file_read(std::cin, rs::run::solver, objective);
+  if (rs::options.formulaName.empty() && rs::options.verbosity.get() > 0)
+    std::cout << "c No filename given, reading from standard input" << std::endl;
+  {
+    rs::LineReader in(rs::options.formulaName);
+    rs::stats.PARSEBYTES = rs::aux::timeCall<size_t>(
+        [&] { return rs::parsing::file_read(in, rs::run::solver, objective); },
+        rs::stats.PARSETIME);
+  }
+  if (rs::options.graphBench) {
+    rs::run::solver.benchmarkCentrality();
+    return 0;
+  }
+  if (rs::options.parseOnly) {
+    if (rs::options.staticFeatures) rs::stats.staticFeatures.print(std::cout);
+    rs::stats.printParse();
+    return 0;
   }
 
   signal(SIGINT, SIGINT_interrupt);
@@ -79,11 +79,20 @@ const int conflLimit64 = 30;
 const int conflLimit96 = 46;
 const int conflLimit128 = 62;
 
-using IntVecIt = std::vector<int>::iterator;
-
+// Variable activities are rescaled by actRescaleV once one exceeds actLimitV. Both are powers of two, so the
+// rescaling is exact and multiplies instead of divides. The type is set with the CMake option activity.
+#if defined(ACTFLOAT)
+using ActValV = float;
+const ActValV actLimitV = 0x1p60f;  // ~1e18 << 2^(2^7)
+#elif defined(ACTLONGDOUBLE)
 using ActValV = long double;
-const ActValV actLimitV = (ActValV)1e300 * (ActValV)1e300 * (ActValV)1e300 * (ActValV)1e300 * (ActValV)1e300 *
-                          (ActValV)1e300 * (ActValV)1e300 * (ActValV)1e300;  // ~1e2400 << 2^(2^13)
+const ActValV actLimitV = 0x1p7970L;  // ~1e2400 << 2^(2^14)
+#else
+using ActValV = double;
+const ActValV actLimitV = 0x1p332;  // ~1e100 << 2^(2^10)
+#endif
+const ActValV actInitV = 1 / actLimitV;
+const ActValV actRescaleV = 1 / (actLimitV * actLimitV);  // exact, and still a normal number for each type
 using ActValC = float;
 const ActValC actLimitC = 1e30;  // ~1e30 << 2^(2^7)
 
@@ -0,0 +1,19 @@
+#!/bin/bash
+
+# Reports the conflict analysis time and the time per conflict on every given instance.
+# usage: run_analysis_bench.sh binary timeout instance...
+
+binary=$1
+timeout=$2
+shift 2
+
+echo "binary: $binary"
+echo "timeout: $timeout"
+echo ""
+
+for instance in "$@"; do
+  echo "$instance"
+  $binary --verbosity=1 --timeout="$timeout" "$instance" |
+    awk '/^c conflict analysis time/ { t = $5 } /^c conflicts / { n = $3 }
+         END { printf "c analysis time %g s\nc analysis conflicts %d\nc analysis per conflict %g us\n", t, n, (n > 0 ? 1e6 * t / n : 0) }'
+done
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+# Reports the run time and iterations of the centrality heuristics on every given instance.
+# usage: run_graph_bench.sh binary threads instance...
+
+binary=$1
+threads=$2
+shift 2
+
+echo "binary: $binary"
+echo "threads: $threads"
+echo ""
+
+for instance in "$@"; do
+  echo "$instance"
+  $binary --graph-bench --graph-threads="$threads" "$instance" | grep "^c graph"
+done
@@ -0,0 +1,15 @@
+#!/bin/bash
+
+# Reports the parse time and throughput of every given instance.
+# usage: run_parse_bench.sh binary instance...
+
+binary=$1
+shift
+
+echo "binary: $binary"
+echo ""
+
+for instance in "$@"; do
+  echo "$instance"
+  $binary --parse-only "$instance" | grep "^c parse"
+done
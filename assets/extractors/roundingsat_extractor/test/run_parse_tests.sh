@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Checks that small OPB inputs with blank, whitespace-only and trailing lines are parsed and solved correctly, and
+# that the formula cache reproduces the static features and rejects corrupt data.
+# usage: run_parse_tests.sh binary
+
+binary=$1
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+errors=0
+
+# check <name> <expected start of the summary line> <instance contents>
+check() {
+  printf "$3" > "$dir/$1.opb"
+  output=$($binary "$dir/$1.opb" 2>&1)
+  if ! grep -q "^$2" <<<"$output"; then
+    echo "$1: expected $2"
+    echo "$output"
+    errors=$((errors + 1))
+  else
+    echo "$1: ok"
+  fi
+}
+
+check blank_lines "OPT,1," "* #variable= 2 #constraint= 1\nmin: +1 x1 +1 x2 ;\n\n+1 x1 +1 x2 >= 1 ;\n"
+check whitespace_lines "OPT,1," "* #variable= 2 #constraint= 1\nmin: +1 x1 +1 x2 ;\n  \n+1 x1 +1 x2 >= 1 ;\n\t \n"
+check trailing_lines "UNSAT," "* #variable= 1 #constraint= 2\n+1 x1 >= 1 ;\n+1 ~x1 >= 1 ;\n\n\n   \n"
+check crlf_lines "UNSAT," "* #variable= 1 #constraint= 2\r\n+1 x1 >= 1 ;\r\n \r\n+1 ~x1 >= 1 ;\r\n\r\n"
+
+# the static features read from a cache written without --static-features must match those of a cold run
+printf "* #variable= 3 #constraint= 2\nmin: +1 x1 -2 x2 ;\n+1 x1 +1 x2 +1 ~x3 >= 1 ;\n+2 x1 +1 x2 = 2 ;\n" > "$dir/features.opb"
+cold=$($binary "$dir/features.opb" --static-features --parse-only | grep "^c static-features")
+$binary "$dir/features.opb" --cache-file="$dir/features.cache" --parse-only > /dev/null
+cached=$($binary "$dir/features.opb" --static-features --cache-file="$dir/features.cache" --parse-only --verbosity=1)
+if ! grep -q "^c Reading cached formula" <<<"$cached" || [ "$(grep "^c static-features" <<<"$cached")" != "$cold" ]; then
+  echo "cached_static_features: expected $cold"
+  echo "$cached"
+  errors=$((errors + 1))
+else
+  echo "cached_static_features: ok"
+fi
+
+# corrupt <name> <expected error> <bytes written over the end of the cache> <bytes cut from the end>
+corrupt() {
+  cp "$dir/features.cache" "$dir/$1.cache"
+  size=$(stat -c %s "$dir/$1.cache")
+  [ -n "$3" ] && printf "$3" | dd of="$dir/$1.cache" bs=1 seek=$((size - 4)) conv=notrunc status=none
+  [ "$4" -gt 0 ] && truncate -s $((size - $4)) "$dir/$1.cache"
+  output=$($binary "$dir/$1.cache" 2>&1)
+  if ! grep -q "^Error: $2" <<<"$output"; then
+    echo "$1: expected $2"
+    echo "$output"
+    errors=$((errors + 1))
+  else
+    echo "$1: ok"
+  fi
+}
+
+corrupt cache_literal_range "Corrupt cache file" "\x7f\x7f\x7f\x7f" 0
+corrupt cache_literal_zero "Corrupt cache file" "\x00\x00\x00\x00" 0
+corrupt cache_truncated "Truncated cache file" "" 4
+
+echo "errors: $errors"
+[ $errors -eq 0 ]
@@ -0,0 +1,75 @@
+/***********************************************************************
+Copyright (c) 2014-2020, Jan Elffers
+Copyright (c) 2019-2021, Jo Devriendt
+Copyright (c) 2020-2021, Stephan Gocht
+Copyright (c) 2014-2021, Jakob Nordström
+
+Parts of the code were copied or adapted from MiniSat.
+
+MiniSat -- Copyright (c) 2003-2006, Niklas Een, Niklas Sorensson
+           Copyright (c) 2007-2010  Niklas Sorensson
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+
+// Prints a binary trace written by roundingsat --trace-file as text, one event per line, oldest first:
+//   v <#variables> <#conflicts>
+//   d <decision literal> <#conflicts>
+//   r <#restarts> <#conflicts>
+//   s 0 <#conflicts>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "Trace.hpp"
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <trace file>" << std::endl;
+    return 1;
+  }
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    std::cerr << "Error: cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+  char magic[sizeof(rs::Trace::magic)];
+  uint64_t total = 0, stored = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(&total), sizeof(total));
+  in.read(reinterpret_cast<char*>(&stored), sizeof(stored));
+  if (!in || std::memcmp(magic, rs::Trace::magic, sizeof(magic)) != 0) {
+    std::cerr << "Error: " << argv[1] << " is not a RoundingSat trace" << std::endl;
+    return 1;
+  }
+  std::cout << "c " << total << " events recorded, last " << stored << " kept\n";
+  static const char codes[] = {'v', 'd', 'r', 's'};
+  rs::Trace::Record rec;
+  for (uint64_t i = 0; i < stored; ++i) {
+    if (!in.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+      std::cerr << "Error: " << argv[1] << " is truncated after " << i << " records" << std::endl;
+      return 1;
+    }
+    char code = rec.event < sizeof(codes) ? codes[rec.event] : '?';
+    std::cout << code << ' ' << rec.value << ' ' << rec.conflicts << '\n';
+  }
+  return 0;
+}
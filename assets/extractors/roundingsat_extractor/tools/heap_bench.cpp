@@ -0,0 +1,122 @@
+/***********************************************************************
+Copyright (c) 2014-2020, Jan Elffers
+Copyright (c) 2019-2021, Jo Devriendt
+Copyright (c) 2020-2021, Stephan Gocht
+Copyright (c) 2014-2021, Jakob Nordström
+
+Parts of the code were copied or adapted from MiniSat.
+
+MiniSat -- Copyright (c) 2003-2006, Niklas Een, Niklas Sorensson
+           Copyright (c) 2007-2010  Niklas Sorensson
+
+Permission is hereby granted, free of charge, to any person obtaining a
+copy of this software and associated documentation files (the
+"Software"), to deal in the Software without restriction, including
+without limitation the rights to use, copy, modify, merge, publish,
+distribute, sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so, subject to
+the following conditions:
+
+The above copyright notice and this permission notice shall be included
+in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+***********************************************************************/
+
+
+// Times OrderHeap::recalculate and OrderHeap::resize against draining the heap and inserting every variable again,
+// and checks that the heap then removes the variables by decreasing activity, ties going to the lower variable.
+// usage: heap_bench [#variables (default 1000000)] [rounds (default 10)]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "SolverStructs.hpp"
+
+using namespace rs;
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the implementation that recalculate and resize replace
+void reinsertAll(OrderHeap& heap, int newsize) {
+  std::vector<Var> variables;
+  while (!heap.empty()) variables.push_back(heap.removeMax());
+  heap.tree.clear();
+  while (heap.cap < newsize) heap.cap = heap.cap * resize_factor + 1;
+  heap.tree.resize(2 * (heap.cap + 1), -1);
+  for (Var x : variables) heap.insert(x);
+}
+
+std::vector<Var> drain(OrderHeap heap) {
+  std::vector<Var> order;
+  while (!heap.empty()) order.push_back(heap.removeMax());
+  return order;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  int rounds = argc > 2 ? std::atoi(argv[2]) : 10;
+  if (n < 1 || rounds < 1) {
+    std::cerr << "Usage: " << argv[0] << " [#variables] [rounds]" << std::endl;
+    return 1;
+  }
+  std::mt19937 rng(n);
+  // a coarse range of activities, so that many variables tie
+  std::uniform_int_distribution<int> draw(0, n / 16);
+  std::vector<ActValV> activity(n + 1, 0);
+  OrderHeap heap(activity);
+  heap.resize(n + 1);
+  for (Var v = 1; v <= n; ++v) heap.insert(v);
+
+  std::vector<Var> expected(n);
+  for (Var v = 1; v <= n; ++v) expected[v - 1] = v;
+  double bulk = 0, reinsert = 0;
+  bool correct = true;
+  for (int round = 0; round < rounds; ++round) {
+    for (Var v = 1; v <= n; ++v) activity[v] = draw(rng);
+    OrderHeap copy = heap;
+    auto start = std::chrono::steady_clock::now();
+    heap.recalculate();
+    bulk += secondsSince(start);
+    start = std::chrono::steady_clock::now();
+    reinsertAll(copy, 0);
+    reinsert += secondsSince(start);
+    if (round == 0) {
+      std::stable_sort(expected.begin(), expected.end(), [&](Var x, Var y) { return activity[x] > activity[y]; });
+      correct &= drain(heap) == expected;
+    }
+  }
+  std::cout << "c heap recalculate of " << n << " variables: " << bulk / rounds << " s, reinserting "
+            << reinsert / rounds << " s" << std::endl;
+
+  // growth as when variables are added, which must keep the order of the variables already in the heap
+  std::vector<Var> before = drain(heap);
+  OrderHeap grown = heap;
+  OrderHeap copy = heap;
+  auto start = std::chrono::steady_clock::now();
+  grown.resize(2 * n + 1);
+  double growth = secondsSince(start);
+  start = std::chrono::steady_clock::now();
+  reinsertAll(copy, 2 * n + 1);
+  reinsert = secondsSince(start);
+  correct &= drain(grown) == before;
+  std::cout << "c heap resize to " << grown.cap << " variables: " << growth << " s, reinserting " << reinsert << " s"
+            << std::endl;
+
+  std::cout << "c heap order " << (correct ? "correct" : "WRONG") << std::endl;
+  return correct ? 0 : 1;
+}
@@ -1,92 +1,438 @@
 #include <iostream>
 #include <string>
-#include <fstream>
 #include <cstdio>
+#include <cstring>
 #include <vector>
 #include <climits>
-#include <time.h>
+#include <cmath>
+#include <chrono>
+#include <thread>
 
-//COMPILE: gcc static_features.cpp -lstdc++ -std=c++11 -o build/static_features
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//COMPILE: gcc static_features.cpp -lstdc++ -std=c++11 -O2 -pthread -o build/static_features
+//USAGE:   static_features [--threads N] [--rich] instance.opb[.gz|.xz|.bz2]
+//         static_features [--threads N] --bench instance.opb [...]   (scan throughput in MB/s, on stderr)
 
 using namespace std;
 
-int main(int argc, char *argv[]) {
-	string inst_name(argv[1]);
-	ifstream inst_file(inst_name);
-	
-    string line;
-	string name;
-	int r,v;
-	double r_u=0,r_b=0,r_t=0,r_q=0;
-	double t_fo=0,t_res=0,t_pos_r=0,t_pos_fo=0;
-
-	name = inst_name.substr(inst_name.find_last_of("/\\")+1);
-    name = name.substr(0,name.find_last_of("."));
-
-	// line1: * #variable= 8904 #constraint= 823
-	string line1;
-	getline(inst_file,line1);
-	string aux="";
-	int pos = line1.find("="); 
-	for(pos=pos+1;pos<line1.size();pos++) {
-		if(line1[pos]=='#') break;
-		if(line1[pos]==' ') continue;
-		aux+=line1[pos];
-	}
-	v=stoi(aux);
-	aux="";
-	pos = line1.find("=", pos+1); 
-	for(pos=pos+1;pos<line1.size();pos++) {
-		if(line1[pos]=='#') break;
-		if(line1[pos]==' ') continue;
-		aux+=line1[pos];
-	}
-	r=stoi(aux);
-
-	while(getline(inst_file,line)) {
-		if(line[0]=='*') continue;
-
-		// obj function
-		else if(line.substr(0,3)=="min") {
-			for(int i=3; i<line.length(); i++) {
-				if(line[i]=='+') {
-					t_fo++;
-					t_pos_fo++;
-				}
-				else if(line[i]=='-') {
-					t_fo++;
+// ---------------------------------------------------------------------
+// Input: the instance is read through a single forward pass over its bytes.
+// Plain files are memory mapped, compressed files (detected by their magic
+// bytes) are streamed through the matching decompressor.
+
+struct Input {
+	int fd = -1;
+	const char* data = nullptr;  // mapped file
+	size_t size = 0;
+	FILE* pipe = nullptr;        // decompressor output
+	vector<char> buf;            // window over the decompressed stream
+	size_t head = 0, tail = 0;
+	size_t bytes = 0;            // bytes handed out so far
+	bool eof = false;
+};
+
+static string shell_quote(const string& s) {
+	string q = "'";
+	for (char c : s) {
+		if (c == '\'') q += "'\\''";
+		else q += c;
+	}
+	return q + "'";
+}
+
+static const char* decompressor(const char* p, size_t n) {
+	if (n >= 2 && (unsigned char)p[0] == 0x1f && (unsigned char)p[1] == 0x8b) return "gzip -dc -- ";
+	if (n >= 6 && memcmp(p, "\xfd" "7zXZ\0", 6) == 0) return "xz -dc -- ";
+	if (n >= 3 && memcmp(p, "BZh", 3) == 0) return "bzip2 -dc -- ";
+	return nullptr;
+}
+
+static bool open_input(Input& in, const string& path) {
+	in.fd = open(path.c_str(), O_RDONLY);
+	if (in.fd < 0) return false;
+	struct stat st;
+	if (fstat(in.fd, &st) != 0) return false;
+	in.size = st.st_size;
+	if (in.size > 0) {
+		void* m = mmap(nullptr, in.size, PROT_READ, MAP_PRIVATE, in.fd, 0);
+		if (m == MAP_FAILED) return false;
+		madvise(m, in.size, MADV_SEQUENTIAL);
+		in.data = (const char*)m;
+	}
+	const char* cmd = decompressor(in.data, in.size);
+	if (cmd != nullptr) {
+		munmap((void*)in.data, in.size);
+		in.data = nullptr;
+		in.size = 0;
+		in.pipe = popen((cmd + shell_quote(path)).c_str(), "r");
+		if (in.pipe == nullptr) return false;
+		in.buf.resize(1 << 20);
+	}
+	return true;
+}
+
+// Returns false if the decompressor failed.
+static bool close_input(Input& in) {
+	bool ok = true;
+	if (in.data != nullptr) munmap((void*)in.data, in.size);
+	if (in.pipe != nullptr) ok = pclose(in.pipe) == 0;
+	if (in.fd >= 0) close(in.fd);
+	in = Input();
+	return ok;
+}
+
+// Hands out the next line as [b,e), without its '\n'. Lines never straddle two
+// reads: the unfinished tail of the window is moved to the front before refilling.
+static bool next_line(Input& in, const char*& b, const char*& e) {
+	if (in.pipe == nullptr) {
+		if (in.bytes >= in.size) return false;
+		b = in.data + in.bytes;
+		e = (const char*)memchr(b, '\n', in.size - in.bytes);
+		if (e == nullptr) e = in.data + in.size;
+		in.bytes = e - in.data + 1;
+		return true;
+	}
+	while (true) {
+		const char* w = in.buf.data();
+		const char* nl = (const char*)memchr(w + in.head, '\n', in.tail - in.head);
+		if (nl != nullptr || (in.eof && in.head < in.tail)) {
+			b = w + in.head;
+			e = nl != nullptr ? nl : w + in.tail;
+			in.head = e - w + 1;
+			in.bytes += e - b + 1;
+			return true;
+		}
+		if (in.eof) return false;
+		memmove(in.buf.data(), w + in.head, in.tail - in.head);
+		in.tail -= in.head;
+		in.head = 0;
+		if (in.tail == in.buf.size()) in.buf.resize(2 * in.buf.size());  // line longer than the window
+		size_t got = fread(in.buf.data() + in.tail, 1, in.buf.size() - in.tail, in.pipe);
+		in.tail += got;
+		if (got == 0) in.eof = true;
+	}
+}
+
+// ---------------------------------------------------------------------
+// Features
+
+struct Counts {
+	long long r_u = 0, r_b = 0, r_t = 0, r_q = 0;
+	long long t_fo = 0, t_res = 0, t_pos_r = 0, t_pos_fo = 0;
+
+	void merge(const Counts& o) {
+		r_u += o.r_u; r_b += o.r_b; r_t += o.r_t; r_q += o.r_q;
+		t_fo += o.t_fo; t_res += o.t_res; t_pos_r += o.t_pos_r; t_pos_fo += o.t_pos_fo;
+	}
+};
+
+// line1: * #variable= 8904 #constraint= 823
+static int header_value(const char* e, const char*& pos) {
+	pos = (const char*)memchr(pos, '=', e - pos);
+	string aux = "";
+	if (pos == nullptr) pos = e;
+	else ++pos;
+	for (; pos < e; pos++) {
+		if (*pos == '#') break;
+		if (*pos == ' ') continue;
+		aux += *pos;
+	}
+	return stoi(aux);
+}
+
+// ---------------------------------------------------------------------
+// Rich features (--rich): coefficient, degree, occurrence and objective
+// statistics. Distributions are kept in fixed-size log-scale histograms, so
+// memory only grows with the number of variables.
+
+struct Hist {
+	static const int SUB = 8;                    // buckets per power of two
+	static const int SIZE = 1 + 128 * SUB + 1;   // [0,1), [1,2^128) and an overflow bucket
+	vector<long long> bucket = vector<long long>(SIZE, 0);
+	long long n = 0;
+	double lo = INFINITY, hi = 0, sum = 0, sumsq = 0;
+
+	static int index(double x) {
+		if (x < 1) return 0;
+		int ex;
+		double m = frexp(x, &ex);  // x = m * 2^ex with m in [0.5,1)
+		if (ex > 128) return SIZE - 1;
+		return 1 + (ex - 1) * SUB + (int)((2 * m - 1) * SUB);
+	}
+	// Smallest value falling into bucket i; exact for integers below 2^4.
+	static double lower(int i) {
+		if (i == 0) return 0;
+		if (i == SIZE - 1) return ldexp(1, 128);
+		return ldexp(1 + (double)((i - 1) % SUB) / SUB, (i - 1) / SUB);
+	}
+
+	void add(double x) {
+		bucket[index(x)]++;
+		n++;
+		lo = min(lo, x);
+		hi = max(hi, x);
+		sum += x;
+		sumsq += x * x;
+	}
+	void merge(const Hist& o) {
+		for (int i = 0; i < SIZE; i++) bucket[i] += o.bucket[i];
+		n += o.n;
+		lo = min(lo, o.lo);
+		hi = max(hi, o.hi);
+		sum += o.sum;
+		sumsq += o.sumsq;
+	}
+	double quantile(double q) const {
+		if (n == 0) return 0;
+		long long rank = (long long)(q * (n - 1));
+		for (int i = 0; i < SIZE; i++) {
+			if (rank < bucket[i]) return max(lo, min(hi, lower(i)));
+			rank -= bucket[i];
+		}
+		return hi;
+	}
+	double min_() const { return n > 0 ? lo : 0; }
+	double mean() const { return n > 0 ? sum / n : 0; }
+	double stddev() const { return n > 0 ? sqrt(max(0.0, sumsq / n - mean() * mean())) : 0; }
+};
+
+struct Rich {
+	Hist coef, degree, obj;
+	double tightness = 0;  // sum over constraints of degree / sum of |coefficients|
+	long long rows = 0, eq = 0, clause = 0, card = 0, general = 0;
+	vector<long long> occ;  // constraint occurrences per variable
+
+	explicit Rich(int vars) : occ(max(vars, 0) + 1, 0) {}
+
+	void merge(const Rich& o) {
+		coef.merge(o.coef);
+		degree.merge(o.degree);
+		obj.merge(o.obj);
+		tightness += o.tightness;
+		rows += o.rows; eq += o.eq; clause += o.clause; card += o.card; general += o.general;
+		if (occ.size() < o.occ.size()) occ.resize(o.occ.size(), 0);
+		for (size_t i = 0; i < o.occ.size(); i++) occ[i] += o.occ[i];
+	}
+
+	// Tokenizes one line: "[+-]coef lit [lit...] ... (>=|<=|=) rhs ;" or the "min:" objective.
+	void add_line(const char* b, const char* e) {
+		if (b == e || *b == '*') return;
+		bool objective = e - b >= 3 && b[0] == 'm' && b[1] == 'i' && b[2] == 'n';
+		int rel = 0;  // 1: >=, -1: <=, 2: =
+		double c = 0, rhs = 0, pos = 0, neg = 0, first = -1;
+		bool have_coef = false, in_term = false, uniform = true;
+		const char* p = objective ? b + 3 : b;
+		while (p < e) {
+			while (p < e && (*p == ' ' || *p == '\t' || *p == '\r' || *p == ':')) p++;
+			if (p == e || *p == ';') break;
+			const char* t = p;
+			while (p < e && *p != ' ' && *p != '\t' && *p != '\r' && *p != ';') p++;
+			if (*t == '>' || *t == '<' || *t == '=') {
+				rel = *t == '>' ? 1 : *t == '<' ? -1 : 2;
+				continue;
+			}
+			if (*t == '+' || *t == '-' || (*t >= '0' && *t <= '9')) {
+				double x = 0;
+				for (const char* d = (*t == '+' || *t == '-') ? t + 1 : t; d < p; d++)
+					if (*d >= '0' && *d <= '9') x = 10 * x + (*d - '0');
+				if (*t == '-') x = -x;
+				if (rel != 0) rhs = x;
+				else {
+					c = x;
+					have_coef = true;
+					in_term = false;
 				}
+				continue;
+			}
+			// literal, "x12" or "~x12"; further literals of the same term form a product
+			const char* d = t;
+			while (d < p && (*d < '0' || *d > '9')) d++;
+			long long var = 0;
+			for (; d < p && *d >= '0' && *d <= '9'; d++) var = 10 * var + (*d - '0');
+			if (!objective) {
+				if ((size_t)var >= occ.size()) occ.resize(var + 1, 0);
+				occ[var]++;
 			}
+			if (in_term || !have_coef) continue;
+			in_term = true;
+			double m = fabs(c);
+			if (objective) {
+				obj.add(m);
+				continue;
+			}
+			coef.add(m);
+			if (c > 0) pos += m;
+			else neg += m;
+			if (first < 0) first = m;
+			else if (m != first) uniform = false;
 		}
+		if (objective || rel == 0) return;
+		// normalized degree of the >= form (the <= form is negated first)
+		double deg = rel == -1 ? pos - rhs : rhs + neg;
+		rows++;
+		if (rel == 2) eq++;
+		degree.add(max(deg, 0.0));
+		if (pos + neg > 0) tightness += deg / (pos + neg);
+		if (first < 0 || !uniform) general++;
+		else if (deg <= first) clause++;
+		else card++;
+	}
+};
 
-		// Constraints
-		else {
-			int t=0;
-			for(int i=0; i<line.length(); i++) {
-				if(line[i]=='+') { 
-					t++;
-					t_res++;
-					t_pos_r++;
-				}
-				else if(line[i]=='-') {
-					t++;
-					t_res++;
-				}
-				else if(line[i]=='>' || line[i]=='=' || line[i]=='<') {
-				    break;
-				}
+static void print_rich(const Rich& f, int v) {
+	double rows = f.rows > 0 ? f.rows : 1;
+	long long vars = max(v, (int)f.occ.size() - 1), unused = 0, occ_max = 0;
+	double s1 = 0, s2 = 0, s3 = 0;
+	for (long long i = 1; i <= vars; i++) {
+		long long o = i < (long long)f.occ.size() ? f.occ[i] : 0;
+		unused += o == 0;
+		occ_max = max(occ_max, o);
+		s1 += o;
+	}
+	double mean = vars > 0 ? s1 / vars : 0;
+	for (long long i = 1; i <= vars; i++) {
+		double d = (i < (long long)f.occ.size() ? f.occ[i] : 0) - mean;
+		s2 += d * d;
+		s3 += d * d * d;
+	}
+	double sd = vars > 0 ? sqrt(s2 / vars) : 0;
+	double skew = sd > 0 ? s3 / vars / (sd * sd * sd) : 0;
+	double spread = f.obj.n > 0 && f.obj.min_() > 0 ? log10(f.obj.hi / f.obj.min_()) : 0;
+
+	cout << " " << f.coef.min_() << " " << f.coef.quantile(0.25) << " " << f.coef.quantile(0.5) << " " << f.coef.quantile(0.75) << " " << f.coef.hi << " " << f.coef.mean();
+	cout << " " << f.degree.min_() << " " << f.degree.quantile(0.25) << " " << f.degree.quantile(0.5) << " " << f.degree.quantile(0.75) << " " << f.degree.hi << " " << f.degree.mean() << " " << f.tightness / rows;
+	cout << " " << mean << " " << sd << " " << occ_max << " " << skew << " " << (vars > 0 ? (double)unused / vars : 0);
+	cout << " " << f.clause / rows << " " << f.card / rows << " " << f.general / rows << " " << f.eq / rows;
+	cout << " " << f.obj.min_() << " " << f.obj.hi << " " << f.obj.mean() << " " << f.obj.stddev() << " " << spread;
+}
+
+static void scan_line(const char* b, const char* e, Counts& c) {
+	if (b == e) return;
+	if (*b == '*') return;
+
+	// obj function
+	if (e - b >= 3 && b[0] == 'm' && b[1] == 'i' && b[2] == 'n') {
+		for (const char* p = b + 3; p < e; p++) {
+			if (*p == '+') {
+				c.t_fo++;
+				c.t_pos_fo++;
 			}
-			if(t==1) r_u++;
-			else if(t>1) {
-				if(t==2) r_b++;
-				else if(t==3) r_t++;
-				else if(t>=4) r_q++;
+			else if (*p == '-') {
+				c.t_fo++;
 			}
 		}
+		return;
+	}
 
+	// Constraints
+	int t = 0, pos = 0;
+	for (const char* p = b; p < e; p++) {
+		if (*p == '+') {
+			t++;
+			pos++;
+		}
+		else if (*p == '-') {
+			t++;
+		}
+		else if (*p == '>' || *p == '=' || *p == '<') {
+			break;
+		}
 	}
+	c.t_res += t;
+	c.t_pos_r += pos;
+	if (t == 1) c.r_u++;
+	else if (t == 2) c.r_b++;
+	else if (t == 3) c.r_t++;
+	else if (t >= 4) c.r_q++;
+}
 
-	int t_tot = t_fo+t_res; 
+static void scan_lines(const char* p, const char* end, Counts& c, Rich* rich) {
+	while (p < end) {
+		const char* e = (const char*)memchr(p, '\n', end - p);
+		if (e == nullptr) e = end;
+		scan_line(p, e, c);
+		if (rich != nullptr) rich->add_line(p, e);
+		p = e + 1;
+	}
+}
+
+// Start of the first line following a constraint end (';' and a newline) at or after p.
+static const char* constraint_boundary(const char* p, const char* end) {
+	while (p < end) {
+		const char* semi = (const char*)memchr(p, ';', end - p);
+		if (semi == nullptr) return end;
+		const char* nl = (const char*)memchr(semi, '\n', end - semi);
+		if (nl == nullptr) return end;
+		p = nl + 1;
+		if (nl == semi + 1 || (nl == semi + 2 && semi[1] == '\r')) return p;
+	}
+	return end;
+}
+
+// Every thread counts the lines of one chunk into its own counters, which are
+// summed afterwards. Chunks only end at constraint boundaries, so no line is split.
+static void scan_parallel(const char* p, const char* end, int threads, Counts& c, Rich* rich) {
+	size_t len = end - p;
+	if (threads <= 1 || len < ((size_t)threads << 16)) {
+		scan_lines(p, end, c, rich);
+		return;
+	}
+	vector<const char*> cuts = {p};
+	for (int i = 1; i < threads; i++) {
+		const char* cut = constraint_boundary(max(cuts.back(), p + len / threads * i), end);
+		cuts.push_back(cut);
+	}
+	cuts.push_back(end);
+	vector<Counts> partial(threads);
+	vector<Rich> partial_rich;
+	if (rich != nullptr) partial_rich.assign(threads, Rich((int)rich->occ.size() - 1));
+	auto part_rich = [&](int i) { return rich != nullptr ? &partial_rich[i] : nullptr; };
+	vector<thread> workers;
+	for (int i = 1; i < threads; i++)
+		workers.emplace_back(scan_lines, cuts[i], cuts[i + 1], ref(partial[i]), part_rich(i));
+	scan_lines(cuts[0], cuts[1], partial[0], part_rich(0));
+	for (thread& w : workers) w.join();
+	for (const Counts& part : partial) c.merge(part);
+	for (const Rich& part : partial_rich) rich->merge(part);
+}
+
+// Returns false if the instance could not be read. Rich features are only
+// collected when rich is set; its per-variable counters are sized from the header.
+static bool scan(const string& path, int threads, int& r, int& v, Counts& c, Rich* rich, size_t& bytes) {
+	Input in;
+	if (!open_input(in, path)) {
+		close_input(in);
+		return false;
+	}
+	const char *b, *e;
+	if (next_line(in, b, e)) {
+		const char* pos = b;
+		v = header_value(e, pos);
+		r = header_value(e, pos);
+	}
+	if (rich != nullptr) *rich = Rich(v);
+	if (in.pipe == nullptr) {  // the whole file is addressable, so it can be cut into chunks
+		scan_parallel(in.data + min(in.bytes, in.size), in.data + in.size, threads, c, rich);
+		in.bytes = in.size;
+	} else {
+		while (next_line(in, b, e)) {
+			scan_line(b, e, c);
+			if (rich != nullptr) rich->add_line(b, e);
+		}
+	}
+	bytes = in.bytes;
+	return close_input(in);
+}
+
+static void print_features(int r, int v, const Counts& c, const Rich* rich) {
+	double r_u = c.r_u, r_b = c.r_b, r_t = c.r_t, r_q = c.r_q;
+	double t_fo = c.t_fo, t_res = c.t_res, t_pos_r = c.t_pos_r, t_pos_fo = c.t_pos_fo;
+
+	int t_tot = t_fo+t_res;
 	t_pos_fo = (t_fo>0) ? t_pos_fo/t_fo : 0;
 	t_pos_r = (t_res>0) ? t_pos_r/t_res : 0;
 	t_fo = (t_tot>0) ? t_fo/t_tot : 0;
@@ -94,10 +440,65 @@ int main(int argc, char *argv[]) {
 	r_u = (r>0) ? r_u/r : 0;
 	r_b = (r>0) ? r_b/r : 0;
 	r_t = (r>0) ? r_t/r : 0;
-	r_q = (r>0) ? r_q/r : 0;	
+	r_q = (r>0) ? r_q/r : 0;
+
+	cout << r << " " << v << " " << r_u << " " << r_b << " " << r_t << " " << r_q << " " << t_fo << " " << t_res << " " << t_pos_r << " " << t_pos_fo;
+	if (rich != nullptr) print_rich(*rich, v);
+	cout << endl;
+}
 
-	cout << r << " " << v << " " << r_u << " " << r_b << " " << r_t << " " << r_q << " " << t_fo << " " << t_res << " " << t_pos_r << " " << t_pos_fo << endl;
-	inst_file.close();
+// Scans every file repeatedly for at least a second and reports the throughput
+// over the (decompressed) bytes.
+static int bench(const vector<string>& files, int threads, bool rich) {
+	for (const string& f : files) {
+		int r = 0, v = 0, reps = 0;
+		size_t bytes = 0;
+		auto start = chrono::steady_clock::now();
+		double secs = 0;
+		do {
+			Counts c;
+			Rich features(0);
+			if (!scan(f, threads, r, v, c, rich ? &features : nullptr, bytes)) {
+				cerr << "Could not open " << f << endl;
+				return 1;
+			}
+			reps++;
+			secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		} while (secs < 1.0);
+		double mb = (double)bytes / (1 << 20);
+		cerr << f << ": " << mb << " MB, " << reps << " scans, " << mb * reps / secs << " MB/s" << endl;
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	int threads = 1;
+	bool bench_mode = false, rich = false;
+	vector<string> files;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--bench") bench_mode = true;
+		else if (arg == "--rich") rich = true;
+		else if (arg == "--threads" && i + 1 < argc) threads = atoi(argv[++i]);
+		else if (arg.substr(0, 10) == "--threads=") threads = atoi(arg.c_str() + 10);
+		else files.push_back(arg);
+	}
+	if (threads < 1) threads = thread::hardware_concurrency();
+	if (files.empty() || threads < 1) {
+		cerr << "Usage: " << argv[0] << " [--threads N] [--rich] [--bench] instance.opb" << endl;
+		return 1;
+	}
+	if (bench_mode) return bench(files, threads, rich);
+
+	int r = 0, v = 0;
+	Counts c;
+	Rich features(0);
+	size_t bytes = 0;
+	if (!scan(files[0], threads, r, v, c, rich ? &features : nullptr, bytes)) {
+		cerr << "Could not open " << files[0] << endl;
+		return 1;
+	}
+	print_features(r, v, c, rich ? &features : nullptr);
 
 	return 0;
-}
\ No newline at end of file
+}
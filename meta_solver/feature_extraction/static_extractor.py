@@ -3,7 +3,17 @@ import os
 
 STATIC_EXTRACTOR_PATH = "" # Will be set in main.py
 
-def extract_static_features(instance_path: str) -> list[float]:
+RICH_STATIC_FEATURES_KEYS = [
+    "coef_min", "coef_q25", "coef_median", "coef_q75", "coef_max", "coef_mean",
+    "degree_min", "degree_q25", "degree_median", "degree_q75", "degree_max", "degree_mean",
+    "mean_tightness",
+    "var_occurrence_mean", "var_occurrence_std", "var_occurrence_max", "var_occurrence_skew",
+    "pct_unused_variables",
+    "pct_clauses", "pct_cardinality", "pct_general", "pct_equalities",
+    "obj_coef_min", "obj_coef_max", "obj_coef_mean", "obj_coef_std", "obj_coef_log10_spread"
+]
+
+def extract_static_features(instance_path: str, rich: bool = False) -> list[float]:
     print("Extracting Static features...\n")
     
     static_features_keys = [
@@ -18,8 +28,12 @@ def extract_static_features(instance_path: str) -> list[float]:
 
     cmd = [
         STATIC_EXTRACTOR_PATH,
-        instance_path
+        "--threads", str(os.cpu_count() or 1)
     ]
+    if rich:
+        # Appends the RICH_STATIC_FEATURES_KEYS values after the ten base features
+        cmd.append("--rich")
+    cmd.append(instance_path)
     
     result = subprocess.run(cmd, stdout=subprocess.PIPE, text=True, check=True)
     output = result.stdout